@@ -0,0 +1,398 @@
+#include <benchmark/benchmark.h>
+
+#include <atomic>
+#include <coroutine>
+#include <cstdint>
+#include <exception>
+#include <memory>
+#include <string>
+#include <thread>
+#include <tuple>
+#include <vector>
+
+#include "basic_event.hpp"
+#include "event.hpp"
+
+using namespace stel;
+
+// Publish latency as a function of the number of subscribers.
+static void BM_EventPublish(benchmark::State& state) {
+  auto ev = std::make_shared<Event<int>>();
+  std::vector<Event<int>::Subscription> subs;
+  subs.reserve(state.range(0));
+  for (int64_t i = 0; i < state.range(0); i++) {
+    subs.push_back(ev->subscribe([](int v) { benchmark::DoNotOptimize(v); }));
+  }
+
+  int value = 0;
+  for (auto _ : state) {
+    ev->publish(value++);
+  }
+  state.SetItemsProcessed(state.iterations() * state.range(0));
+  state.SetComplexityN(state.range(0));
+}
+
+BENCHMARK(BM_EventPublish)->RangeMultiplier(10)->Range(1, 10000)->Complexity();
+
+// BM_EventPublish for the single-threaded policy: a vector of direct calls.
+static void BM_LocalEventPublish(benchmark::State& state) {
+  BasicEvent<SingleThreaded, int> ev;
+  std::vector<LocalEvent<int>::Subscription> subs;
+  subs.reserve(state.range(0));
+  for (int64_t i = 0; i < state.range(0); i++) {
+    subs.push_back(ev.subscribe([](int v) { benchmark::DoNotOptimize(v); }));
+  }
+
+  int value = 0;
+  for (auto _ : state) {
+    ev.publish(value++);
+  }
+  state.SetItemsProcessed(state.iterations() * state.range(0));
+  state.SetComplexityN(state.range(0));
+}
+
+BENCHMARK(BM_LocalEventPublish)->RangeMultiplier(10)->Range(1, 10000)->Complexity();
+
+// Publish throughput with many threads hammering the same Event.
+static void BM_EventPublishThreaded(benchmark::State& state) {
+  static auto ev = std::make_shared<Event<int>>();
+  static std::vector<Event<int>::Subscription> subs = [] {
+    std::vector<Event<int>::Subscription> s;
+    for (int i = 0; i < 8; i++) {
+      s.push_back(ev->subscribe([](int v) { benchmark::DoNotOptimize(v); }));
+    }
+    return s;
+  }();
+
+  int value = 0;
+  for (auto _ : state) {
+    ev->publish(value++);
+  }
+  state.SetItemsProcessed(state.iterations());
+}
+
+BENCHMARK(BM_EventPublishThreaded)->ThreadRange(1, 64)->UseRealTime();
+
+// Cost seen by the publisher of an async Event, subscribers run elsewhere.
+static void BM_EventPublishAsync(benchmark::State& state) {
+  auto ev = std::make_shared<Event<int>>(
+      AsyncOptions{static_cast<std::size_t>(state.range(0)), 4096, Backpressure::Block});
+  std::vector<Event<int>::Subscription> subs;
+  for (int i = 0; i < 8; i++) {
+    subs.push_back(ev->subscribe([](int v) { benchmark::DoNotOptimize(v); }));
+  }
+
+  int value = 0;
+  for (auto _ : state) {
+    ev->publish(value++);
+  }
+  ev->flush();
+  state.SetItemsProcessed(state.iterations());
+}
+
+BENCHMARK(BM_EventPublishAsync)->Arg(1)->Arg(4)->UseRealTime();
+
+// 256 samples to 8 subscribers: one publish per sample (range(0) == 0),
+// publish_batch to plain subscribers (1), or to batch subscribers (2).
+static void BM_EventPublishBatch(benchmark::State& state) {
+  using Ev = Event<double>;
+  auto ev = std::make_shared<Ev>();
+  std::vector<Ev::Subscription> subs;
+  for (int i = 0; i < 8; i++) {
+    if (state.range(0) == 2) {
+      subs.push_back(ev->subscribe_batch([](Ev::Batch samples) noexcept {
+        double sum = 0;
+        for (const auto& [v] : samples) sum += v;
+        benchmark::DoNotOptimize(sum);
+      }));
+    } else {
+      subs.push_back(ev->subscribe([](double v) noexcept { benchmark::DoNotOptimize(v); }));
+    }
+  }
+
+  std::vector<std::tuple<double>> samples(256, std::tuple<double>(1.0));
+  for (auto _ : state) {
+    if (state.range(0) == 0) {
+      for (const auto& [v] : samples) ev->publish(v);
+    } else {
+      ev->publish_batch(samples);
+    }
+  }
+  state.SetItemsProcessed(state.iterations() * samples.size());
+}
+
+BENCHMARK(BM_EventPublishBatch)->DenseRange(0, 2);
+
+// range(0) symbol-specific subscribers, one event per symbol in turn.
+// range(1) == 0 filters inside each callback, 1 uses a key index.
+static void BM_EventPublishKeyed(benchmark::State& state) {
+  struct Quote {
+    int symbol;
+    double px;
+  };
+  static const auto by_symbol = key_of([](const Quote& q) { return q.symbol; });
+
+  auto ev = std::make_shared<Event<Quote>>();
+  std::vector<Event<Quote>::Subscription> subs;
+  const int symbols = static_cast<int>(state.range(0));
+  for (int i = 0; i < symbols; i++) {
+    if (state.range(1) == 0) {
+      subs.push_back(ev->subscribe([i](const Quote& q) {
+        if (q.symbol != i) return;
+        benchmark::DoNotOptimize(q.px);
+      }));
+    } else {
+      subs.push_back(ev->subscribe(by_symbol.is(i), [](const Quote& q) {
+        benchmark::DoNotOptimize(q.px);
+      }));
+    }
+  }
+
+  int next = 0;
+  for (auto _ : state) {
+    ev->publish(Quote{next, 1.0});
+    next = next + 1 == symbols ? 0 : next + 1;
+  }
+  state.SetItemsProcessed(state.iterations());
+}
+
+BENCHMARK(BM_EventPublishKeyed)->ArgsProduct({{10, 1000}, {0, 1}});
+
+// Fan a range(0)-byte payload out to 8 mailbox subscribers. Every mailbox
+// shares one envelope; range(1) selects publish by copy (0) or by move (1).
+static void BM_EventPublishMailboxPayload(benchmark::State& state) {
+  auto ev = std::make_shared<Event<std::string>>();
+  auto exec = std::make_shared<ThreadPoolExecutor>(1);
+  std::vector<Event<std::string>::Subscription> subs;
+  for (int i = 0; i < 8; i++) {
+    subs.push_back(ev->subscribe([](const std::string& s) { benchmark::DoNotOptimize(s.data()); },
+                                 MailboxOptions{4096, Backpressure::Block, exec}));
+  }
+
+  const std::string payload(static_cast<std::size_t>(state.range(0)), 'x');
+  const bool by_move = state.range(1) != 0;
+  for (auto _ : state) {
+    if (by_move) {
+      std::string s = payload;
+      ev->publish(std::move(s));
+    } else {
+      ev->publish(payload);
+    }
+  }
+  exec->flush();
+  state.SetBytesProcessed(state.iterations() * state.range(0));
+}
+
+BENCHMARK(BM_EventPublishMailboxPayload)
+    ->ArgsProduct({{64, 4096}, {0, 1}})
+    ->UseRealTime();
+
+// Broadcast to range(0) subscribers, serially (range(1) = 0) or split over
+// a FanoutPool of range(1) helpers in chunks of 256.
+static void BM_EventPublishFanout(benchmark::State& state) {
+  const auto helpers = static_cast<std::size_t>(state.range(1));
+  auto pool = helpers ? std::make_shared<FanoutPool>(FanoutOptions{helpers, 256}) : nullptr;
+  auto ev = pool ? std::make_shared<Event<int>>(pool) : std::make_shared<Event<int>>();
+  std::vector<Event<int>::Subscription> subs;
+  subs.reserve(state.range(0));
+  for (int64_t i = 0; i < state.range(0); i++) {
+    subs.push_back(ev->subscribe([](int v) { benchmark::DoNotOptimize(v); }));
+  }
+
+  int value = 0;
+  for (auto _ : state) {
+    ev->publish(value++);
+  }
+  state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+
+BENCHMARK(BM_EventPublishFanout)->ArgsProduct({{1000, 10000}, {0, 1, 3}})->UseRealTime();
+
+// Publish to one coroutine consumer: range(0) = 0 resumes it inline on the
+// publishing thread, 1 on a single-thread executor. Compare with a mailbox
+// subscriber, which always hands off to its executor.
+struct BenchCoro {
+  struct promise_type {
+    BenchCoro get_return_object() { return {std::coroutine_handle<promise_type>::from_promise(*this)}; }
+    std::suspend_never initial_suspend() noexcept { return {}; }
+    std::suspend_always final_suspend() noexcept { return {}; }
+    void return_void() {}
+    void unhandled_exception() { std::terminate(); }
+  };
+  std::coroutine_handle<promise_type> h;
+};
+
+static BenchCoro drain_stream(Event<int>::Stream& events, std::atomic<std::int64_t>& seen) {
+  while (auto e = co_await events.next()) {
+    benchmark::DoNotOptimize(std::get<0>(*e));
+    seen.store(seen.load(std::memory_order_relaxed) + 1, std::memory_order_release);
+  }
+}
+
+static void BM_EventStream(benchmark::State& state) {
+  auto ev = std::make_shared<Event<int>>();
+  auto exec = state.range(0) ? std::make_shared<ThreadPoolExecutor>(1) : nullptr;
+  auto events = ev->stream(StreamOptions{4096, Backpressure::Block, exec});
+  std::atomic<std::int64_t> seen{0};
+  BenchCoro coro = drain_stream(events, seen);
+
+  int value = 0;
+  for (auto _ : state) {
+    ev->publish(value++);
+  }
+  while (seen.load(std::memory_order_acquire) < value) {
+    std::this_thread::yield();
+  }
+  events = Event<int>::Stream{};
+  if (exec) exec->flush();
+  coro.h.destroy();
+  state.SetItemsProcessed(state.iterations());
+}
+
+BENCHMARK(BM_EventStream)->Arg(0)->Arg(1)->UseRealTime();
+
+// Publish latency while range(0) background threads keep the writer side
+// busy without changing the subscriber set (mailbox_stats() takes the
+// writer mutex). With the hot read state on its own cache line this should
+// track BM_EventPublish; before the split every lock invalidated slots_.
+static void BM_EventPublishWriterTraffic(benchmark::State& state) {
+  auto ev = std::make_shared<Event<int>>();
+  std::vector<Event<int>::Subscription> subs;
+  for (int i = 0; i < 8; i++) {
+    subs.push_back(ev->subscribe([](int v) noexcept { benchmark::DoNotOptimize(v); }));
+  }
+
+  std::atomic<bool> stop{false};
+  std::vector<std::thread> writers;
+  for (int64_t t = 0; t < state.range(0); t++) {
+    writers.emplace_back([&] {
+      while (!stop.load(std::memory_order_relaxed)) {
+        benchmark::DoNotOptimize(ev->mailbox_stats(0));
+      }
+    });
+  }
+
+  int value = 0;
+  for (auto _ : state) {
+    ev->publish(value++);
+  }
+  stop.store(true);
+  for (auto& w : writers) {
+    w.join();
+  }
+  state.SetItemsProcessed(state.iterations());
+}
+
+BENCHMARK(BM_EventPublishWriterTraffic)->Arg(0)->Arg(1)->Arg(3)->UseRealTime();
+
+// Subscribe + unsubscribe round trip on an Event that already has
+// range(0) subscribers, while range(1) background threads keep publishing.
+static void BM_EventSubscribeChurn(benchmark::State& state) {
+  auto ev = std::make_shared<Event<int>>();
+  std::vector<Event<int>::Subscription> subs;
+  for (int64_t i = 0; i < state.range(0); i++) {
+    subs.push_back(ev->subscribe([](int v) { benchmark::DoNotOptimize(v); }));
+  }
+
+  std::atomic<bool> stop{false};
+  std::vector<std::thread> publishers;
+  for (int64_t t = 0; t < state.range(1); t++) {
+    publishers.emplace_back([&] {
+      int value = 0;
+      while (!stop.load(std::memory_order_relaxed)) {
+        ev->publish(value++);
+      }
+    });
+  }
+
+  for (auto _ : state) {
+    auto s = ev->subscribe([](int v) { benchmark::DoNotOptimize(v); });
+    s.unsubscribe();
+  }
+
+  stop.store(true, std::memory_order_relaxed);
+  for (auto& t : publishers) {
+    t.join();
+  }
+  state.SetItemsProcessed(state.iterations());
+}
+
+BENCHMARK(BM_EventSubscribeChurn)
+    ->ArgsProduct({{1, 100, 1000}, {0, 1, 4}})
+    ->UseRealTime();
+
+// Wiring range(0) handlers one subscribe at a time vs. in one batch.
+static void BM_EventSubscribeSequential(benchmark::State& state) {
+  for (auto _ : state) {
+    auto ev = std::make_shared<Event<int>>();
+    std::vector<Event<int>::Subscription> subs;
+    subs.reserve(state.range(0));
+    for (int64_t i = 0; i < state.range(0); i++) {
+      subs.push_back(ev->subscribe([](int v) { benchmark::DoNotOptimize(v); }));
+    }
+    state.PauseTiming();
+    subs.clear();
+    state.ResumeTiming();
+  }
+  state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+
+BENCHMARK(BM_EventSubscribeSequential)->RangeMultiplier(10)->Range(10, 10000);
+
+static void BM_EventSubscribeMany(benchmark::State& state) {
+  for (auto _ : state) {
+    auto ev = std::make_shared<Event<int>>();
+    auto tx = ev->transaction();
+    for (int64_t i = 0; i < state.range(0); i++) {
+      tx.subscribe([](int v) { benchmark::DoNotOptimize(v); });
+    }
+    auto subs = tx.commit();
+    state.PauseTiming();
+    subs.clear();
+    state.ResumeTiming();
+  }
+  state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+
+BENCHMARK(BM_EventSubscribeMany)->RangeMultiplier(10)->Range(10, 10000);
+
+// Tearing down range(0) subscriptions one by one.
+static void BM_EventUnsubscribeAll(benchmark::State& state) {
+  for (auto _ : state) {
+    state.PauseTiming();
+    auto ev = std::make_shared<Event<int>>();
+    std::vector<Event<int>::Subscription> subs;
+    subs.reserve(state.range(0));
+    for (int64_t i = 0; i < state.range(0); i++) {
+      subs.push_back(ev->subscribe([](int v) { benchmark::DoNotOptimize(v); }));
+    }
+    state.ResumeTiming();
+
+    subs.clear();
+  }
+  state.SetItemsProcessed(state.iterations() * state.range(0));
+  state.SetComplexityN(state.range(0));
+}
+
+BENCHMARK(BM_EventUnsubscribeAll)->RangeMultiplier(10)->Range(10, 10000)->Complexity();
+
+// Same teardown through a SubscriptionGroup: one rebuild for the lot.
+static void BM_EventUnsubscribeGroup(benchmark::State& state) {
+  for (auto _ : state) {
+    state.PauseTiming();
+    auto ev = std::make_shared<Event<int>>();
+    SubscriptionGroup<int> group;
+    for (int64_t i = 0; i < state.range(0); i++) {
+      group += ev->subscribe([](int v) { benchmark::DoNotOptimize(v); });
+    }
+    state.ResumeTiming();
+
+    group.clear();
+  }
+  state.SetItemsProcessed(state.iterations() * state.range(0));
+  state.SetComplexityN(state.range(0));
+}
+
+BENCHMARK(BM_EventUnsubscribeGroup)->RangeMultiplier(10)->Range(10, 10000)->Complexity();
+
+BENCHMARK_MAIN();
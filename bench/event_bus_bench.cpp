@@ -0,0 +1,183 @@
+#include <benchmark/benchmark.h>
+
+#include <memory>
+#include <random>
+#include <string>
+#include <vector>
+
+#include "event.hpp"
+#include "static_bus.hpp"
+
+using namespace stel;
+
+namespace {
+
+using Bus = EventBus<int>;
+
+// A bus with `topics` channels, one subscriber each.
+struct BusFixture {
+  explicit BusFixture(std::size_t topics) {
+    names.reserve(topics);
+    subs.reserve(topics);
+    for (std::size_t i = 0; i < topics; i++) {
+      names.push_back("topic." + std::to_string(i));
+      subs.push_back(bus.subscribe(names.back(),
+            [](int v) { benchmark::DoNotOptimize(v); }));
+    }
+  }
+
+  Bus bus;
+  std::vector<std::string> names;
+  std::vector<Bus::EventType::Subscription> subs;
+};
+
+// Indices into the topic list, precomputed so the RNG stays out of the loop.
+std::vector<std::size_t> random_indices(std::size_t topics, std::size_t n) {
+  std::mt19937_64 rng(42);
+  std::uniform_int_distribution<std::size_t> dist(0, topics - 1);
+  std::vector<std::size_t> out(n);
+  for (auto& i : out) {
+    i = dist(rng);
+  }
+  return out;
+}
+
+} // namespace
+
+// Publish to a random existing topic as the number of topics grows.
+static void BM_BusPublishHit(benchmark::State& state) {
+  BusFixture fx(state.range(0));
+  auto idx = random_indices(fx.names.size(), 4096);
+
+  std::size_t i = 0;
+  for (auto _ : state) {
+    fx.bus.publish(fx.names[idx[i++ & 4095]], 1);
+  }
+  state.SetItemsProcessed(state.iterations());
+  state.SetComplexityN(state.range(0));
+}
+
+BENCHMARK(BM_BusPublishHit)->RangeMultiplier(10)->Range(10, 1000000)->Complexity();
+
+// Publish to a topic nobody subscribed to.
+static void BM_BusPublishMiss(benchmark::State& state) {
+  BusFixture fx(state.range(0));
+  const std::string missing = "no.such.topic";
+
+  for (auto _ : state) {
+    fx.bus.publish(missing, 1);
+  }
+  state.SetItemsProcessed(state.iterations());
+}
+
+BENCHMARK(BM_BusPublishMiss)->RangeMultiplier(100)->Range(10, 1000000);
+
+// Publish with a string literal, looked up through std::string_view.
+static void BM_BusPublishLiteral(benchmark::State& state) {
+  BusFixture fx(1000);
+
+  for (auto _ : state) {
+    fx.bus.publish("topic.500", 1);
+  }
+  state.SetItemsProcessed(state.iterations());
+}
+
+BENCHMARK(BM_BusPublishLiteral);
+
+// Publish through a pre-resolved Topic handle, no hashing or lookup.
+static void BM_BusPublishHandle(benchmark::State& state) {
+  BusFixture fx(1000);
+  auto topic = fx.bus.topic("topic.500");
+
+  for (auto _ : state) {
+    topic.publish(1);
+  }
+  state.SetItemsProcessed(state.iterations());
+}
+
+BENCHMARK(BM_BusPublishHandle);
+
+// Same as BM_BusPublishHandle with the topic journaled in memory: the cost
+// of one more queued subscriber feeding the journal's append task.
+static void BM_BusPublishJournaled(benchmark::State& state) {
+  BusFixture fx(1000);
+  auto journal = fx.bus.journal("topic.500", JournalOptions{4096, {}, 1 << 16});
+  auto topic = fx.bus.topic("topic.500");
+
+  for (auto _ : state) {
+    topic.publish(1);
+  }
+  journal->flush();
+  state.SetItemsProcessed(state.iterations());
+}
+
+BENCHMARK(BM_BusPublishJournaled);
+
+namespace {
+struct BenchTopic : StaticTopic<"topic.500", int> {};
+struct OtherTopic : StaticTopic<"topic.501", int> {};
+} // namespace
+
+// Same as BM_BusPublishHandle, with the topic resolved at compile time.
+static void BM_StaticBusPublish(benchmark::State& state) {
+  StaticBus<OtherTopic, BenchTopic> bus;
+  auto sub = bus.subscribe<BenchTopic>([](int v) { benchmark::DoNotOptimize(v); });
+
+  for (auto _ : state) {
+    bus.publish<BenchTopic>(1);
+  }
+  state.SetItemsProcessed(state.iterations());
+}
+
+BENCHMARK(BM_StaticBusPublish);
+
+// Publish to random topics with range(0) wildcard subscriptions matching
+// each of them. After the first publish per topic the matches are cached.
+static void BM_BusPublishWildcard(benchmark::State& state) {
+  BusFixture fx(1000);
+  std::vector<Bus::EventType::Subscription> wild;
+  for (int64_t i = 0; i < state.range(0); i++) {
+    wild.push_back(fx.bus.subscribe(i % 2 ? "topic.*" : "#",
+          [](int v) { benchmark::DoNotOptimize(v); }));
+  }
+  auto idx = random_indices(fx.names.size(), 4096);
+
+  std::size_t i = 0;
+  for (auto _ : state) {
+    fx.bus.publish(fx.names[idx[i++ & 4095]], 1);
+  }
+  state.SetItemsProcessed(state.iterations());
+}
+
+BENCHMARK(BM_BusPublishWildcard)->Arg(0)->Arg(1)->Arg(2)->Arg(8);
+
+// Many threads publishing to random topics of a shared bus.
+static void BM_BusPublishThreaded(benchmark::State& state) {
+  static BusFixture fx(10000);
+  auto idx = random_indices(fx.names.size(), 4096);
+
+  std::size_t i = state.thread_index();
+  for (auto _ : state) {
+    fx.bus.publish(fx.names[idx[i++ & 4095]], 1);
+  }
+  state.SetItemsProcessed(state.iterations());
+}
+
+BENCHMARK(BM_BusPublishThreaded)->ThreadRange(1, 64)->UseRealTime();
+
+// Cost of creating a new topic on a bus that already has range(0) topics.
+static void BM_BusTopicCreation(benchmark::State& state) {
+  BusFixture fx(state.range(0));
+  std::vector<Bus::EventType::Subscription> extra;
+  std::size_t n = 0;
+
+  for (auto _ : state) {
+    extra.push_back(fx.bus.subscribe("new." + std::to_string(n++),
+          [](int v) { benchmark::DoNotOptimize(v); }));
+  }
+  state.SetItemsProcessed(state.iterations());
+}
+
+BENCHMARK(BM_BusTopicCreation)->RangeMultiplier(100)->Range(10, 100000);
+
+BENCHMARK_MAIN();
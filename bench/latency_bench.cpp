@@ -0,0 +1,149 @@
+#include <benchmark/benchmark.h>
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "event.hpp"
+
+using namespace stel;
+
+// End-to-end latency, publish to callback, under load. The measured thread
+// publishes events stamped with the time of publish while range(1)
+// background threads publish unstamped ones to the same Event; subscribers
+// record now - stamp into a LatencyHistogram, reported as p50/p90/p99/max
+// counters in nanoseconds. range(0) is the number of subscribers.
+
+namespace {
+
+std::uint64_t now_ns() {
+  return std::chrono::duration_cast<std::chrono::nanoseconds>(
+      std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+// Background publishers, running until destroyed.
+class Load {
+ public:
+  Load(int64_t threads, std::function<void()> publish) {
+    for (int64_t i = 0; i < threads; i++) {
+      threads_.emplace_back([this, publish] {
+        while (!stop_.load(std::memory_order_relaxed)) publish();
+      });
+    }
+  }
+
+  ~Load() {
+    stop_.store(true);
+    for (auto& t : threads_) t.join();
+  }
+
+ private:
+  std::atomic<bool> stop_{false};
+  std::vector<std::thread> threads_;
+};
+
+// Subscriber body: stamped events only, background ones are 0.
+struct Recorder {
+  void operator()(std::uint64_t stamp) const {
+    if (stamp) hist->record(now_ns() - stamp);
+  }
+  LatencyHistogram* hist;
+};
+
+void report(benchmark::State& state, const LatencyHistogram& hist) {
+  const LatencySummary s = hist.summary();
+  state.counters["p50_ns"] = static_cast<double>(s.p50);
+  state.counters["p90_ns"] = static_cast<double>(s.p90);
+  state.counters["p99_ns"] = static_cast<double>(s.p99);
+  state.counters["max_ns"] = static_cast<double>(s.max);
+  state.SetItemsProcessed(state.iterations());
+}
+
+} // namespace
+
+// Synchronous Event: latency is the wait for earlier subscribers.
+static void BM_LatencySync(benchmark::State& state) {
+  LatencyHistogram hist;
+  auto ev = std::make_shared<Event<std::uint64_t>>();
+  std::vector<Event<std::uint64_t>::Subscription> subs;
+  for (int64_t i = 0; i < state.range(0); i++) {
+    subs.push_back(ev->subscribe(Recorder{&hist}));
+  }
+  {
+    Load load(state.range(1), [&] { ev->publish(std::uint64_t{0}); });
+    for (auto _ : state) {
+      ev->publish(now_ns());
+    }
+  }
+  report(state, hist);
+}
+
+BENCHMARK(BM_LatencySync)->ArgsProduct({{1, 64}, {0, 3}})->UseRealTime();
+
+// Async Event: queueing plus the hop to a dispatcher thread.
+static void BM_LatencyAsync(benchmark::State& state) {
+  LatencyHistogram hist;
+  auto ev = std::make_shared<Event<std::uint64_t>>(AsyncOptions{2, 4096, Backpressure::Block});
+  std::vector<Event<std::uint64_t>::Subscription> subs;
+  for (int64_t i = 0; i < state.range(0); i++) {
+    subs.push_back(ev->subscribe(Recorder{&hist}));
+  }
+  {
+    Load load(state.range(1), [&] { ev->publish(std::uint64_t{0}); });
+    for (auto _ : state) {
+      ev->publish(now_ns());
+    }
+  }
+  ev->flush();
+  report(state, hist);
+}
+
+BENCHMARK(BM_LatencyAsync)->ArgsProduct({{1, 64}, {0, 3}})->UseRealTime();
+
+// Mailbox subscribers draining on a shared two-thread executor.
+static void BM_LatencyMailbox(benchmark::State& state) {
+  LatencyHistogram hist;
+  auto exec = std::make_shared<ThreadPoolExecutor>(2);
+  auto ev = std::make_shared<Event<std::uint64_t>>();
+  std::vector<Event<std::uint64_t>::Subscription> subs;
+  for (int64_t i = 0; i < state.range(0); i++) {
+    subs.push_back(ev->subscribe(Recorder{&hist}, MailboxOptions{4096, Backpressure::Block, exec}));
+  }
+  {
+    Load load(state.range(1), [&] { ev->publish(std::uint64_t{0}); });
+    for (auto _ : state) {
+      ev->publish(now_ns());
+    }
+  }
+  exec->flush();
+  subs.clear();
+  report(state, hist);
+}
+
+BENCHMARK(BM_LatencyMailbox)->ArgsProduct({{1, 64}, {0, 3}})->UseRealTime();
+
+// EventBus topic with half the subscribers on a wildcard, publishing by name.
+static void BM_LatencyBus(benchmark::State& state) {
+  LatencyHistogram hist;
+  EventBus<std::uint64_t> bus;
+  std::vector<EventBus<std::uint64_t>::EventType::Subscription> subs;
+  for (int64_t i = 0; i < state.range(0); i++) {
+    subs.push_back(bus.subscribe(i % 2 ? "load.*" : "load.measured", Recorder{&hist}));
+  }
+  {
+    Load load(state.range(1), [&] { bus.publish("load.measured", std::uint64_t{0}); });
+    for (auto _ : state) {
+      bus.publish("load.measured", now_ns());
+    }
+  }
+  report(state, hist);
+}
+
+BENCHMARK(BM_LatencyBus)->ArgsProduct({{1, 64}, {0, 3}})->UseRealTime();
+
+BENCHMARK_MAIN();
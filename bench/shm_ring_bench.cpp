@@ -0,0 +1,78 @@
+#include <benchmark/benchmark.h>
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <string>
+#include <thread>
+
+#include <unistd.h>
+
+#include "shm_ring.hpp"
+
+using namespace stel;
+
+namespace {
+
+std::string ring_name(const char* tag) {
+  return "/stel-bench-" + std::to_string(::getpid()) + "-" + tag;
+}
+
+}  // namespace
+
+// Publisher cost with nobody sleeping on the ring.
+static void BM_ShmPublish(benchmark::State& state) {
+  const auto name = ring_name("publish");
+  auto ring = ShmRing<std::uint64_t, double>::create(name, 4096);
+  std::uint64_t i = 0;
+  for (auto _ : state) {
+    ring->publish(i++, 1.0);
+  }
+  state.SetItemsProcessed(state.iterations());
+  ShmRing<std::uint64_t, double>::unlink(name);
+}
+
+BENCHMARK(BM_ShmPublish);
+
+// Ping-pong through two rings, reader spinning (range(0) == 0) or
+// sleeping on the futex (1). Reports one-way latency.
+static void BM_ShmRoundTrip(benchmark::State& state) {
+  const auto ping_name = ring_name("ping");
+  const auto pong_name = ring_name("pong");
+  auto ping = ShmRing<std::uint64_t>::create(ping_name, 1024);
+  auto pong = ShmRing<std::uint64_t>::create(pong_name, 1024);
+  const bool sleep = state.range(0) == 1;
+  std::atomic<bool> stop{false};
+
+  auto in = ping->reader();
+  std::thread echo([&, in]() mutable {
+    while (!stop.load(std::memory_order_relaxed)) {
+      if (sleep) in.wait(std::chrono::milliseconds(10));
+      in.poll([&](std::uint64_t v) { pong->publish(v); });
+      if (!sleep) std::this_thread::yield();
+    }
+  });
+
+  auto back = pong->reader();
+  std::uint64_t i = 0;
+  for (auto _ : state) {
+    ping->publish(i++);
+    while (back.poll([](std::uint64_t) { }) == 0) {
+      if (sleep) {
+        back.wait(std::chrono::milliseconds(10));
+      } else {
+        std::this_thread::yield();  // Single-core hosts need the echo thread to run
+      }
+    }
+  }
+  stop = true;
+  in.interrupt();
+  echo.join();
+  state.SetItemsProcessed(state.iterations() * 2);
+  ShmRing<std::uint64_t>::unlink(ping_name);
+  ShmRing<std::uint64_t>::unlink(pong_name);
+}
+
+BENCHMARK(BM_ShmRoundTrip)->Arg(0)->Arg(1)->UseRealTime();
+
+BENCHMARK_MAIN();
@@ -0,0 +1,187 @@
+#pragma once
+
+#include <algorithm>
+#include <charconv>
+#include <cstddef>
+#include <fstream>
+#include <iterator>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <vector>
+
+#if defined(__linux__)
+#include <dirent.h>
+#include <pthread.h>
+#include <sched.h>
+#endif
+
+namespace stel {
+
+// Parse a kernel CPU list such as "0-3,8,10-11". Malformed pieces are
+// skipped; the result is sorted and unique.
+//
+inline std::vector<int> parse_cpu_list(std::string_view list) {
+	std::vector<int> cpus;
+	while (!list.empty()) {
+		const std::size_t comma = list.find(',');
+		std::string_view part = list.substr(0, comma);
+		list = comma == std::string_view::npos ? std::string_view{} : list.substr(comma + 1);
+		while (!part.empty() && (part.back() == '\n' || part.back() == ' ')) part.remove_suffix(1);
+		int lo = 0, hi = 0;
+		const char* end = part.data() + part.size();
+		auto [p, ec] = std::from_chars(part.data(), end, lo);
+		if (ec != std::errc{}) continue;
+		hi = lo;
+		if (p != end && *p == '-') {
+			auto [q, ec2] = std::from_chars(p + 1, end, hi);
+			if (ec2 != std::errc{} || q != end || hi < lo) continue;
+		} else if (p != end) {
+			continue;
+		}
+		for (int c = lo; c <= hi; c++) {
+			cpus.push_back(c);
+		}
+	}
+	std::sort(cpus.begin(), cpus.end());
+	cpus.erase(std::unique(cpus.begin(), cpus.end()), cpus.end());
+	return cpus;
+}
+
+// Restrict the calling thread to cpus. Returns false where pinning is not
+// supported or the set was refused (e.g. CPUs outside our cgroup).
+//
+inline bool pin_current_thread(const std::vector<int>& cpus) {
+#if defined(__linux__)
+	if (cpus.empty()) return false;
+	cpu_set_t set;
+	CPU_ZERO(&set);
+	for (int c : cpus) {
+		if (c >= 0 && c < CPU_SETSIZE) CPU_SET(c, &set);
+	}
+	return ::pthread_setaffinity_np(::pthread_self(), sizeof(set), &set) == 0;
+#else
+	(void)cpus;
+	return false;
+#endif
+}
+
+// CPU the calling thread is running on, -1 if unknown.
+//
+inline int current_cpu() noexcept {
+#if defined(__linux__)
+	return ::sched_getcpu();
+#else
+	return -1;
+#endif
+}
+
+struct NumaNode {
+	int					id;		// Kernel node number, not necessarily dense
+	std::vector<int>	cpus;
+};
+
+/// CpuTopology lists the NUMA nodes of the machine and the CPUs of each.
+///
+/// - Read from sysfs (/sys/devices/system/node) on Linux, restricted to the
+///   CPUs this process may run on. Machines without NUMA information (or
+///   other platforms) get a single node holding every usable CPU.
+/// - node_of(cpu) is a table lookup; current_node() adds one sched_getcpu(),
+///   which is a vDSO call on Linux.
+///
+/// Typical use:
+///   const auto& topo = CpuTopology::system();
+///   for (const auto& n : topo.nodes()) { ... n.cpus ... }
+///
+class CpuTopology {
+public:
+	explicit CpuTopology(std::vector<NumaNode> nodes) : nodes_(std::move(nodes)) {
+		nodes_.erase(std::remove_if(nodes_.begin(), nodes_.end(),
+				[](const NumaNode& n) { return n.cpus.empty(); }), nodes_.end());
+		if (nodes_.empty()) nodes_.push_back(NumaNode{0, {0}});
+		for (std::size_t i = 0; i < nodes_.size(); i++) {
+			for (int c : nodes_[i].cpus) {
+				if (static_cast<std::size_t>(c) >= index_.size()) index_.resize(c + 1, 0);
+				index_[c] = i;
+			}
+		}
+	}
+
+	// The machine's topology, read once.
+	//
+	static const CpuTopology& system() {
+		static const CpuTopology topo = from_sysfs("/sys/devices/system/node", allowed_cpus());
+		return topo;
+	}
+
+	// Nodes found under root (as /sys/devices/system/node), keeping only
+	// allowed CPUs. Falls back to one node of allowed CPUs.
+	//
+	static CpuTopology from_sysfs(const std::string& root, const std::vector<int>& allowed) {
+		std::vector<NumaNode> nodes;
+#if defined(__linux__)
+		if (DIR* dir = ::opendir(root.c_str())) {
+			while (const dirent* e = ::readdir(dir)) {
+				const std::string_view name(e->d_name);
+				int id = 0;
+				if (name.size() <= 4 || name.substr(0, 4) != "node") continue;
+				auto [p, ec] = std::from_chars(name.data() + 4, name.data() + name.size(), id);
+				if (ec != std::errc{} || p != name.data() + name.size()) continue;
+				std::ifstream in(root + "/" + std::string(name) + "/cpulist");
+				std::string list((std::istreambuf_iterator<char>(in)), std::istreambuf_iterator<char>());
+				NumaNode node{id, {}};
+				for (int c : parse_cpu_list(list)) {
+					if (std::binary_search(allowed.begin(), allowed.end(), c)) node.cpus.push_back(c);
+				}
+				nodes.push_back(std::move(node));
+			}
+			::closedir(dir);
+		}
+#else
+		(void)root;
+#endif
+		std::sort(nodes.begin(), nodes.end(), [](const NumaNode& a, const NumaNode& b) { return a.id < b.id; });
+		if (std::none_of(nodes.begin(), nodes.end(), [](const NumaNode& n) { return !n.cpus.empty(); })) {
+			nodes.assign(1, NumaNode{0, allowed});
+		}
+		return CpuTopology(std::move(nodes));
+	}
+
+	// CPUs the calling thread may run on, sorted.
+	//
+	static std::vector<int> allowed_cpus() {
+		std::vector<int> cpus;
+#if defined(__linux__)
+		cpu_set_t set;
+		CPU_ZERO(&set);
+		if (::sched_getaffinity(0, sizeof(set), &set) == 0) {
+			for (int c = 0; c < CPU_SETSIZE; c++) {
+				if (CPU_ISSET(c, &set)) cpus.push_back(c);
+			}
+		}
+#endif
+		if (cpus.empty()) {
+			const unsigned n = std::max(1u, std::thread::hardware_concurrency());
+			for (unsigned c = 0; c < n; c++) {
+				cpus.push_back(static_cast<int>(c));
+			}
+		}
+		return cpus;
+	}
+
+	const std::vector<NumaNode>& nodes() const noexcept { return nodes_; }
+
+	// Index into nodes() of cpu's node; unknown CPUs map to the first node.
+	//
+	std::size_t node_of(int cpu) const noexcept {
+		return cpu >= 0 && static_cast<std::size_t>(cpu) < index_.size() ? index_[cpu] : 0;
+	}
+
+	std::size_t current_node() const noexcept { return node_of(current_cpu()); }
+
+private:
+	std::vector<NumaNode>		nodes_;
+	std::vector<std::size_t>	index_;	// CPU -> position in nodes_
+};
+
+} // namespace stel
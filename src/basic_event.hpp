@@ -0,0 +1,327 @@
+#pragma once
+
+#include <algorithm>
+#include <concepts>
+#include <cstddef>
+#include <cstdint>
+#include <exception>
+#include <span>
+#include <tuple>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+#include "config.hpp"
+#include "error_sink.hpp"
+#include "event.hpp"
+#include "inplace_function.hpp"
+
+namespace stel {
+
+/// LocalEvent<Ts...> is Event<Ts...> for objects that never leave one thread.
+///
+/// - Same call sites as Event: subscribe(cb, priority), RAII Subscription,
+///   unsubscribe(id), publish(...), publish_batch(span), clear(), error
+///   handler and failure count.
+/// - No atomics, no mutex, no epochs: subscribers sit in one vector sorted by
+///   priority, and publish is a loop of direct calls over it.
+/// - Re-entrant: callbacks may publish, subscribe and unsubscribe, and drop
+///   the last reference to the event. Subscribers added during a publish
+///   first see the next one; removals take effect at once. The vector is
+///   only reshaped once the outermost publish returns.
+/// - Tokens share a plain counted block with the event, so they may outlive
+///   it. Everything, tokens included, must stay on the owning thread.
+/// - Mailboxes, async dispatch, streams and key filters need other threads
+///   and are Event only.
+///
+/// Typical use (or BasicEvent<SingleThreaded, Ts...>, see below):
+///   LocalEvent<int> ev;
+///   auto sub = ev.subscribe([](int v) { use(v); });
+///   ev.publish(42);
+///
+template <typename... Ts>
+class LocalEvent {
+	struct State;
+
+public:
+	using Callback = InplaceFunction<void(const Ts&...), callback_capacity>;
+
+	using Batch = std::span<const std::tuple<Ts...>>;
+
+	LocalEvent() : state_(new State()) { }
+
+	~LocalEvent() {
+		state_->closed = true;
+		State::unref(state_);
+	}
+
+	LocalEvent(const LocalEvent&)				= delete;
+	LocalEvent& operator =(const LocalEvent&)	= delete;
+
+	// RAII token, as Event::Subscription. Unsubscribing is a scan for the ID.
+	//
+	class Subscription {
+	public:
+		Subscription() = default;
+		~Subscription() { unsubscribe(); }
+
+		Subscription(Subscription&& other) noexcept
+			: state_(std::exchange(other.state_, nullptr)), id_(std::exchange(other.id_, 0)) { }
+
+		Subscription& operator =(Subscription&& other) noexcept {
+			if (this != &other) {
+				unsubscribe();
+				state_ = std::exchange(other.state_, nullptr);
+				id_ = std::exchange(other.id_, 0);
+			}
+			return *this;
+		}
+
+		Subscription(const Subscription&)				= delete;
+		Subscription& operator =(const Subscription&)	= delete;
+
+		// False if already unsubscribed, by ID or clear(), or if the event
+		// is gone.
+		//
+		bool unsubscribe() {
+			State* state = std::exchange(state_, nullptr);
+			if (!state) return false;
+			const bool removed = !state->closed && state->remove(id_);
+			State::unref(state);
+			return removed;
+		}
+
+		explicit operator bool() const noexcept { return state_ != nullptr; }
+
+		std::size_t id() const noexcept { return state_ ? id_ : 0; }
+
+	private:
+		friend class LocalEvent;
+		Subscription(State* state, std::size_t id) noexcept : state_(state), id_(id) { ++state_->refs; }
+
+		State*		state_ = nullptr;
+		std::size_t	id_ = 0;
+	}; // class Subscription
+
+	// Add a subscriber. Callables declared noexcept are invoked without a
+	// try block. Higher priorities run first, equal ones in subscription
+	// order.
+	//
+	template <typename F>
+		requires std::constructible_from<Callback, F>
+	[[nodiscard]] Subscription subscribe(F&& cb, int priority = 0) {
+		constexpr bool nothrow = std::is_nothrow_invocable_v<std::decay_t<F>&, const Ts&...>;
+		const std::size_t id = state_->next_id++;
+		state_->add(Entry{Callback(std::forward<F>(cb)), id, priority, nothrow, true});
+		return Subscription{state_, id};
+	}
+
+	// Manually unsubscribe by ID (normally handled by Subscription).
+	//
+	bool unsubscribe(std::size_t id) { return state_->remove(id); }
+
+	std::size_t unsubscribe(std::span<const std::size_t> ids) {
+		std::size_t removed = 0;
+		for (std::size_t id : ids) {
+			removed += state_->remove(id);
+		}
+		return removed;
+	}
+
+	void publish(const Ts&... args) const {
+		State* state = state_;
+		Scope scope(state);
+		const std::size_t n = state->subs.size();
+		for (std::size_t i = 0; i < n; i++) {
+			const Entry& e = state->subs[i];
+			if (e.live) state->call(e, [&] { e.fn(args...); });
+		}
+	}
+
+	// Each subscriber gets every event of the span before the next one runs.
+	//
+	void publish_batch(Batch events) const {
+		State* state = state_;
+		Scope scope(state);
+		const std::size_t n = state->subs.size();
+		for (std::size_t i = 0; i < n; i++) {
+			const Entry& e = state->subs[i];
+			for (const auto& ev : events) {
+				if (!e.live) break;
+				state->call(e, [&] { std::apply(e.fn, ev); });
+			}
+		}
+	}
+
+	// Nothing is ever queued.
+	//
+	void flush() const noexcept { }
+
+	bool is_async() const noexcept { return false; }
+
+	// Route exceptions thrown by subscribers to handler, with the ID of the
+	// failing subscription. Pass nullptr to go back to swallowing them.
+	//
+	void set_error_handler(ErrorHandler handler) { state_->on_error = std::move(handler); }
+
+	std::uint64_t failure_count() const noexcept { return state_->failures; }
+
+	std::size_t subscriber_count() const noexcept { return state_->live; }
+
+	void clear() {
+		for (auto& e : state_->subs) {
+			e.live = false;
+		}
+		state_->added.clear();
+		state_->dead = state_->subs.size();
+		state_->live = 0;
+		state_->settle();
+	}
+
+private:
+	struct Entry {
+		Callback	fn;
+		std::size_t	id;
+		int			priority;
+		bool		nothrow;
+		bool		live;
+	};
+
+	// Shared by the event and its tokens; counted without atomics.
+	//
+	struct State {
+		static void unref(State* state) noexcept {
+			if (--state->refs == 0) delete state;
+		}
+
+		// Entries are inserted in priority order, stable. While a publish
+		// is walking subs they wait in added instead.
+		//
+		void add(Entry e) {
+			++live;
+			if (depth > 0) {
+				added.push_back(std::move(e));
+			} else {
+				insert(std::move(e));
+			}
+		}
+
+		void insert(Entry e) {
+			auto pos = std::upper_bound(subs.begin(), subs.end(), e.priority, [](int p, const Entry& x) {
+				return p > x.priority;
+			});
+			subs.insert(pos, std::move(e));
+		}
+
+		bool remove(std::size_t id) {
+			auto pending = std::find_if(added.begin(), added.end(), [&](const Entry& e) { return e.id == id; });
+			if (pending != added.end()) {
+				added.erase(pending);
+				--live;
+				return true;
+			}
+			auto it = std::find_if(subs.begin(), subs.end(), [&](const Entry& e) { return e.id == id && e.live; });
+			if (it == subs.end()) return false;
+			it->live = false;
+			++dead;
+			--live;
+			settle();
+			return true;
+		}
+
+		// Fold in removals and additions, unless a publish is running.
+		//
+		void settle() {
+			if (depth > 0) return;
+			if (dead > 0) {
+				std::erase_if(subs, [](const Entry& e) { return !e.live; });
+				dead = 0;
+			}
+			for (auto& e : added) {
+				insert(std::move(e));
+			}
+			added.clear();
+		}
+
+		template <typename F>
+		void call(const Entry& e, F&& fn) {
+			if (e.nothrow) {
+				fn();
+				return;
+			}
+			try {
+				fn();
+			} catch (...) {
+				++failures;
+				if (!on_error) return;
+				try {
+					on_error(e.id, std::current_exception());
+				} catch (...) {
+				}
+			}
+		}
+
+		std::vector<Entry>	subs;			// Sorted by priority, higher first
+		std::vector<Entry>	added;			// Subscribed during a publish
+		std::size_t			refs = 1;		// The event and each token
+		std::size_t			next_id = 1;
+		std::size_t			live = 0;
+		std::size_t			dead = 0;		// Tombstones in subs
+		unsigned			depth = 0;		// Nested publishes in progress
+		bool				closed = false;	// The event is gone
+		ErrorHandler		on_error;
+		std::uint64_t		failures = 0;
+	};
+
+	// Pins the state for one publish: the event may be destroyed by one of
+	// its subscribers, and subs must not move under the loop.
+	//
+	class Scope {
+	public:
+		explicit Scope(State* state) noexcept : state_(state) {
+			++state_->refs;
+			++state_->depth;
+		}
+
+		~Scope() {
+			if (--state_->depth == 0 && !state_->closed) state_->settle();
+			State::unref(state_);
+		}
+
+		Scope(const Scope&)				= delete;
+		Scope& operator =(const Scope&)	= delete;
+
+	private:
+		State* state_;
+	}; // class Scope
+
+	State* state_;
+};
+
+// Threading policies for BasicEvent.
+//
+struct MultiThreaded {
+	template <typename... Ts>
+	using event_type = Event<Ts...>;
+};
+
+struct SingleThreaded {
+	template <typename... Ts>
+	using event_type = LocalEvent<Ts...>;
+};
+
+// Pick the Event implementation by policy, so that generic code can be
+// instantiated once for shared and once for thread-confined use. The
+// multi-threaded policy is Event itself, not a wrapper, which also means
+// Policy cannot be deduced from a BasicEvent argument: name it.
+//
+// Typical use:
+//   template <typename Policy>
+//   void wire(BasicEvent<Policy, double>& changed) { ... changed.subscribe(...) ... }
+//   auto ev = std::make_shared<BasicEvent<SingleThreaded, double>>();
+//   wire<SingleThreaded>(*ev);
+//
+template <typename Policy, typename... Ts>
+using BasicEvent = typename Policy::template event_type<Ts...>;
+
+} // namespace stel
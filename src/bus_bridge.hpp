@@ -0,0 +1,504 @@
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <cerrno>
+#include <chrono>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <memory>
+#include <mutex>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <system_error>
+#include <thread>
+#include <unordered_map>
+#include <utility>
+#include <variant>
+#include <vector>
+
+#include <arpa/inet.h>
+#include <netdb.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+#include "event.hpp"
+#include "pod_codec.hpp"
+#include "topic_trie.hpp"
+
+namespace stel {
+
+struct BridgeOptions {
+	std::chrono::microseconds	max_delay{200};				// Longest an event waits for its batch
+	std::size_t					max_batch_bytes	= 64 << 10;	// Flush as soon as this much is pending
+	std::size_t					max_pending_bytes = 8 << 20;	// Beyond this, events are dropped
+	// Largest frame either side accepts (kind byte plus body); longer runs
+	// of events are split. BridgeReceiver must be given the same value.
+	std::size_t					max_frame_bytes = 1 << 20;
+};
+
+// Wire format shared by BridgeSender and BridgeReceiver, host byte order:
+//   frame  := u32 size, u8 kind, body[size - 1]
+//   Hello  := u64 PodCodec signature                (first frame)
+//   Topic  := u32 id, name bytes                    (before the id is used)
+//   Events := { u32 id, payload[PodCodec::size] }*  (a run of events)
+// Topic IDs are interned per connection, so events carry 4 bytes of topic.
+//
+namespace bridge {
+
+enum class Kind : std::uint8_t { Hello = 1, Topic = 2, Events = 3 };
+
+inline constexpr std::size_t kFrameHeader = 5;
+
+[[noreturn]] inline void throw_errno(const char* what) {
+	throw std::system_error(errno, std::generic_category(), what);
+}
+
+// Connected TCP socket to host:port, with Nagle disabled (the sender does
+// its own batching). Throws std::system_error.
+//
+inline int connect_tcp(const std::string& host, std::uint16_t port) {
+	addrinfo hints{};
+	hints.ai_family = AF_UNSPEC;
+	hints.ai_socktype = SOCK_STREAM;
+	addrinfo* res = nullptr;
+	const std::string service = std::to_string(port);
+	if (const int rc = ::getaddrinfo(host.c_str(), service.c_str(), &hints, &res); rc != 0) {
+		throw std::runtime_error("getaddrinfo: " + std::string(::gai_strerror(rc)));
+	}
+	int fd = -1;
+	int err = 0;
+	for (addrinfo* ai = res; ai; ai = ai->ai_next) {
+		fd = ::socket(ai->ai_family, ai->ai_socktype | SOCK_CLOEXEC, ai->ai_protocol);
+		if (fd < 0) {
+			err = errno;
+			continue;
+		}
+		if (::connect(fd, ai->ai_addr, ai->ai_addrlen) == 0) break;
+		err = errno;
+		::close(fd);
+		fd = -1;
+	}
+	::freeaddrinfo(res);
+	if (fd < 0) throw std::system_error(err, std::generic_category(), "connect");
+	const int one = 1;
+	::setsockopt(fd, IPPROTO_TCP, TCP_NODELAY, &one, sizeof(one));
+	return fd;
+}
+
+// Listening IPv4 socket on port (0 picks one, see bound_port()).
+//
+inline int listen_tcp(std::uint16_t port, const char* address = "127.0.0.1") {
+	const int fd = ::socket(AF_INET, SOCK_STREAM | SOCK_CLOEXEC, 0);
+	if (fd < 0) throw_errno("socket");
+	const int one = 1;
+	::setsockopt(fd, SOL_SOCKET, SO_REUSEADDR, &one, sizeof(one));
+	sockaddr_in addr{};
+	addr.sin_family = AF_INET;
+	addr.sin_port = htons(port);
+	if (::inet_pton(AF_INET, address, &addr.sin_addr) != 1) {
+		::close(fd);
+		throw std::invalid_argument("listen_tcp: bad IPv4 address");
+	}
+	if (::bind(fd, reinterpret_cast<sockaddr*>(&addr), sizeof(addr)) != 0 || ::listen(fd, 16) != 0) {
+		const int err = errno;
+		::close(fd);
+		throw std::system_error(err, std::generic_category(), "bind/listen");
+	}
+	return fd;
+}
+
+inline std::uint16_t bound_port(int fd) {
+	sockaddr_in addr{};
+	socklen_t len = sizeof(addr);
+	if (::getsockname(fd, reinterpret_cast<sockaddr*>(&addr), &len) != 0) throw_errno("getsockname");
+	return ntohs(addr.sin_port);
+}
+
+inline int accept_tcp(int listener) {
+	const int fd = ::accept4(listener, nullptr, nullptr, SOCK_CLOEXEC);
+	if (fd < 0) throw_errno("accept");
+	const int one = 1;
+	::setsockopt(fd, IPPROTO_TCP, TCP_NODELAY, &one, sizeof(one));
+	return fd;
+}
+
+} // namespace bridge
+
+/// BridgeSender<Ts...> forwards selected EventBus topics to a remote bus.
+///
+/// - forward(bus, topic) subscribes to a literal topic (patterns are
+///   rejected, as by EventBus::topic); every event is
+///   encoded once into the pending batch (PodCodec, trivially copyable Ts)
+///   under a short lock, then the subscriber returns.
+/// - A flusher thread ships the batch in one send(), once max_batch_bytes
+///   are pending or the oldest pending event has waited max_delay;
+///   consecutive events share a frame of up to max_frame_bytes.
+/// - Past max_pending_bytes (slow or stalled link), new events are dropped
+///   and counted rather than stalling local publishers.
+/// - I/O errors stop the bridge, see failed().
+/// - The sender may be destroyed while publishers are still forwarding
+///   through it; their events are dropped.
+///
+/// Typical use:
+///   BridgeSender<Quote> out(bridge::connect_tcp("feed-2", 7001));
+///   out.forward(bus, "quotes.AAPL");
+///
+template <typename... Ts>
+class BridgeSender {
+	using Codec = PodCodec<Ts...>;
+
+	struct State;
+
+public:
+	// Takes ownership of a connected stream socket.
+	//
+	explicit BridgeSender(int fd, BridgeOptions opts = {})
+		: state_(std::make_shared<State>(fd, checked(opts))), flusher_([state = state_] { state->run(); }) {
+		State& s = *state_;
+		std::lock_guard<std::mutex> lk(s.m);
+		const std::uint64_t signature = Codec::signature;
+		const std::size_t at = s.frame(bridge::Kind::Hello, sizeof(signature));
+		std::memcpy(&s.filling[at], &signature, sizeof(signature));
+		s.due = std::chrono::steady_clock::now();
+		s.cv.notify_one();
+	}
+
+	// Callbacks a publisher is still running may outlive us: they hold the
+	// state and find it stopped, so what they send is dropped.
+	//
+	~BridgeSender() {
+		subs_.clear();
+		{
+			std::lock_guard<std::mutex> lk(state_->m);
+			state_->stop = true;
+		}
+		state_->cv.notify_one();
+		flusher_.join();	// Ships what is still pending
+		::close(state_->fd);
+	}
+
+	BridgeSender(const BridgeSender&)				= delete;
+	BridgeSender& operator =(const BridgeSender&)	= delete;
+
+	// Forward a literal topic of bus. The subscription lives as long as the
+	// sender; bus must outlive it. Throws std::invalid_argument for patterns
+	// and for names too long for a frame.
+	//
+	void forward(EventBus<Ts...>& bus, std::string_view topic) {
+		if (TopicTrie<std::monostate>::is_pattern(topic)) {
+			throw std::invalid_argument("BridgeSender::forward: patterns cannot be forwarded");
+		}
+		State& s = *state_;
+		if (1 + sizeof(std::uint32_t) + topic.size() > s.opts.max_frame_bytes) {
+			throw std::invalid_argument("BridgeSender::forward: topic name exceeds max_frame_bytes");
+		}
+		std::uint32_t id;
+		bool wake;
+		{
+			std::lock_guard<std::mutex> lk(s.m);
+			wake = s.arm();
+			id = s.next_id++;
+			const std::size_t at = s.frame(bridge::Kind::Topic, sizeof(id) + topic.size());
+			std::memcpy(&s.filling[at], &id, sizeof(id));
+			std::memcpy(&s.filling[at + sizeof(id)], topic.data(), topic.size());
+		}
+		if (wake) s.cv.notify_one();
+		subs_.push_back(bus.subscribe(topic, [state = state_, id](const Ts&... args) noexcept {
+			state->send(id, args...);
+		}));
+	}
+
+	std::uint64_t sent() const noexcept { return state_->sent.load(std::memory_order_relaxed); }
+	std::uint64_t dropped() const noexcept { return state_->dropped.load(std::memory_order_relaxed); }
+	bool failed() const noexcept { return state_->failed.load(std::memory_order_relaxed); }
+
+private:
+	static constexpr std::size_t kRecord	= sizeof(std::uint32_t) + Codec::size;
+	static constexpr std::size_t kNone		= SIZE_MAX;
+
+	static BridgeOptions checked(const BridgeOptions& opts) {
+		if (opts.max_frame_bytes < 1 + kRecord || opts.max_frame_bytes > UINT32_MAX) {
+			throw std::invalid_argument("BridgeSender: max_frame_bytes does not fit an event");
+		}
+		return opts;
+	}
+
+	// Everything the forwarding callbacks and the flusher touch, shared
+	// with both so that neither depends on the sender being alive.
+	//
+	struct State {
+		State(int f, const BridgeOptions& o) : fd(f), opts(o) { filling.reserve(batch_capacity()); }
+
+		// A full batch plus the record that tipped it over, so steady-state
+		// batching never reallocates.
+		//
+		std::size_t batch_capacity() const noexcept {
+			return std::min(opts.max_batch_bytes, opts.max_pending_bytes) + bridge::kFrameHeader + kRecord;
+		}
+
+		// Append one event, extending the open Events frame when there is
+		// one. Growing past the reserved batch (a slow link) may fail to
+		// allocate; the event is dropped then, like past max_pending_bytes.
+		//
+		void send(std::uint32_t id, const Ts&... args) noexcept {
+			bool wake = false;
+			{
+				std::lock_guard<std::mutex> lk(m);
+				if (stop || failed.load(std::memory_order_relaxed)
+						|| filling.size() + kRecord > opts.max_pending_bytes) {
+					dropped.fetch_add(1, std::memory_order_relaxed);
+					return;
+				}
+				std::uint32_t size = 0;
+				if (open_events != kNone) std::memcpy(&size, &filling[open_events], sizeof(size));
+				const bool extend = open_events != kNone && size + kRecord <= opts.max_frame_bytes;
+				const std::size_t need = filling.size() + kRecord + (extend ? 0 : bridge::kFrameHeader);
+				if (need > filling.capacity()) {
+					try {
+						filling.reserve(std::max(need, filling.capacity() * 2));
+					} catch (...) {
+						dropped.fetch_add(1, std::memory_order_relaxed);
+						return;
+					}
+				}
+				wake = arm();
+				std::size_t at;
+				if (extend) {
+					at = filling.size();
+					filling.resize(at + kRecord);
+					size += kRecord;
+					std::memcpy(&filling[open_events], &size, sizeof(size));
+				} else {
+					at = frame(bridge::Kind::Events, kRecord);
+					open_events = at - bridge::kFrameHeader;
+				}
+				std::memcpy(&filling[at], &id, sizeof(id));
+				Codec::encode(&filling[at + sizeof(id)], args...);
+				wake = wake || filling.size() >= opts.max_batch_bytes;
+			}
+			if (wake) cv.notify_one();
+		}
+
+		// Requires m. Called before appending: the first bytes of a batch
+		// start its max_delay clock and need the flusher to pick up due.
+		//
+		bool arm() {
+			if (!filling.empty()) return false;
+			due = std::chrono::steady_clock::now() + opts.max_delay;
+			return true;
+		}
+
+		// Requires m. Start a frame with a body of body bytes, return the
+		// offset of the body. Closes the open Events frame.
+		//
+		std::size_t frame(bridge::Kind kind, std::size_t body) {
+			const std::size_t at = filling.size();
+			filling.resize(at + bridge::kFrameHeader + body);
+			const auto size = static_cast<std::uint32_t>(body + 1);
+			std::memcpy(&filling[at], &size, sizeof(size));
+			filling[at + sizeof(size)] = static_cast<unsigned char>(kind);
+			open_events = kNone;
+			return at + bridge::kFrameHeader;
+		}
+
+		void run() {
+			std::vector<unsigned char> sending;
+			sending.reserve(batch_capacity());
+			std::unique_lock<std::mutex> lk(m);
+			for (;;) {
+				// Re-read due on every wakeup: the first event of a batch sets it.
+				while (!stop && filling.size() < opts.max_batch_bytes
+						&& (filling.empty() || std::chrono::steady_clock::now() < due)) {
+					if (due == std::chrono::steady_clock::time_point::max()) {
+						cv.wait(lk);
+					} else {
+						cv.wait_until(lk, due);
+					}
+				}
+				if (filling.empty()) {
+					if (stop) return;
+					due = std::chrono::steady_clock::time_point::max();
+					continue;
+				}
+				// Double buffering: publishers fill one batch while the other
+				// is on the wire.
+				sending.swap(filling);
+				filling.clear();
+				open_events = kNone;
+				due = std::chrono::steady_clock::time_point::max();
+				lk.unlock();
+				const bool ok = write_all(sending);
+				sent.fetch_add(sending.size(), std::memory_order_relaxed);
+				sending.clear();
+				lk.lock();
+				if (!ok) {
+					failed.store(true, std::memory_order_relaxed);
+					filling.clear();
+					return;
+				}
+			}
+		}
+
+		// The whole batch goes out as encoded, in as few send() calls as the
+		// socket allows. MSG_NOSIGNAL: a vanished peer is an error, not SIGPIPE.
+		//
+		bool write_all(const std::vector<unsigned char>& buf) {
+			std::size_t at = 0;
+			while (at < buf.size()) {
+				const ssize_t n = ::send(fd, buf.data() + at, buf.size() - at, MSG_NOSIGNAL);
+				if (n < 0) {
+					if (errno == EINTR) continue;
+					return false;
+				}
+				at += static_cast<std::size_t>(n);
+			}
+			return true;
+		}
+
+		const int								fd;
+		const BridgeOptions						opts;
+		std::mutex								m;
+		std::condition_variable					cv;
+		std::vector<unsigned char>				filling;		// Requires m
+		std::size_t								open_events = kNone;	// Requires m
+		std::chrono::steady_clock::time_point	due = std::chrono::steady_clock::time_point::max();
+		std::uint32_t							next_id = 0;	// Requires m
+		bool									stop = false;	// Requires m
+		std::atomic<std::uint64_t>				sent{0};		// Bytes
+		std::atomic<std::uint64_t>				dropped{0};
+		std::atomic<bool>						failed{false};
+	};
+
+	const std::shared_ptr<State>										state_;
+	std::vector<typename EventBus<Ts...>::EventType::Subscription>	subs_;		// Writer side, not thread-safe
+	std::thread														flusher_;	// Last, started once the rest exists
+};
+
+/// BridgeReceiver<Ts...> reads a BridgeSender stream and republishes every
+/// event on a local bus, through EventBus::publish.
+///
+/// - Runs one reader thread per connection; the destructor shuts the socket
+///   down and joins it.
+/// - A stream whose Hello carries another payload signature, or that is
+///   malformed, is closed; see failed().
+///
+/// Typical use:
+///   BridgeReceiver<Quote> in(bridge::accept_tcp(listener), bus);
+///
+template <typename... Ts>
+class BridgeReceiver {
+	using Codec = PodCodec<Ts...>;
+
+public:
+	// Takes ownership of a connected stream socket. bus must outlive us.
+	// Only opts.max_frame_bytes is used, it must match the sender's.
+	//
+	BridgeReceiver(int fd, EventBus<Ts...>& bus, const BridgeOptions& opts = {})
+		: fd_(fd), max_frame_(opts.max_frame_bytes), bus_(bus), reader_([this] { run(); }) { }
+
+	~BridgeReceiver() {
+		::shutdown(fd_, SHUT_RDWR);
+		reader_.join();
+		::close(fd_);
+	}
+
+	BridgeReceiver(const BridgeReceiver&)				= delete;
+	BridgeReceiver& operator =(const BridgeReceiver&)	= delete;
+
+	std::uint64_t received() const noexcept { return received_.load(std::memory_order_relaxed); }
+	bool failed() const noexcept { return failed_.load(std::memory_order_relaxed); }
+
+	// True once the peer closed the stream (or it failed).
+	//
+	bool done() const noexcept { return done_.load(std::memory_order_acquire); }
+
+private:
+	static constexpr std::size_t kRecord	= sizeof(std::uint32_t) + Codec::size;
+	static constexpr std::size_t kReadSize	= 64 << 10;
+
+	void run() {
+		std::vector<unsigned char> buf(kReadSize);
+		std::size_t have = 0;
+		for (;;) {
+			if (buf.size() - have < kReadSize / 2) buf.resize(buf.size() * 2);
+			const ssize_t n = ::recv(fd_, buf.data() + have, buf.size() - have, 0);
+			if (n < 0 && errno == EINTR) continue;
+			if (n <= 0) break;
+			have += static_cast<std::size_t>(n);
+
+			std::size_t at = 0;
+			while (have - at >= bridge::kFrameHeader) {
+				std::uint32_t size;
+				std::memcpy(&size, &buf[at], sizeof(size));
+				if (size == 0 || size > max_frame_) return fail();
+				if (have - at < sizeof(size) + size) break;
+				if (!handle(static_cast<bridge::Kind>(buf[at + sizeof(size)]),
+						&buf[at + bridge::kFrameHeader], size - 1)) {
+					return fail();
+				}
+				at += sizeof(size) + size;
+			}
+			std::memmove(buf.data(), buf.data() + at, have - at);
+			have -= at;
+		}
+		done_.store(true, std::memory_order_release);
+	}
+
+	bool handle(bridge::Kind kind, const unsigned char* body, std::size_t size) {
+		if (!hello_ && kind != bridge::Kind::Hello) return false;
+		switch (kind) {
+			case bridge::Kind::Hello: {
+				std::uint64_t signature;
+				if (size != sizeof(signature)) return false;
+				std::memcpy(&signature, body, sizeof(signature));
+				hello_ = signature == Codec::signature;
+				return hello_;
+			}
+			case bridge::Kind::Topic: {
+				std::uint32_t id;
+				if (size < sizeof(id)) return false;
+				std::memcpy(&id, body, sizeof(id));
+				topics_[id].assign(reinterpret_cast<const char*>(body) + sizeof(id), size - sizeof(id));
+				return true;
+			}
+			case bridge::Kind::Events: {
+				if (size % kRecord != 0) return false;
+				for (std::size_t at = 0; at < size; at += kRecord) {
+					std::uint32_t id;
+					std::memcpy(&id, body + at, sizeof(id));
+					auto it = topics_.find(id);
+					if (it == topics_.end()) return false;
+					Codec::decode(body + at + sizeof(id), [&](const Ts&... args) {
+						bus_.publish(it->second, args...);
+					});
+				}
+				received_.fetch_add(size / kRecord, std::memory_order_relaxed);
+				return true;
+			}
+		}
+		return false;
+	}
+
+	void fail() {
+		failed_.store(true, std::memory_order_relaxed);
+		done_.store(true, std::memory_order_release);
+	}
+
+	const int										fd_;
+	const std::size_t								max_frame_;
+	EventBus<Ts...>&								bus_;
+	bool											hello_ = false;	// Reader thread only
+	std::unordered_map<std::uint32_t, std::string>	topics_;		// Reader thread only
+	std::atomic<std::uint64_t>						received_{0};
+	std::atomic<bool>								failed_{false};
+	std::atomic<bool>								done_{false};
+	std::thread										reader_;	// Last, started once the rest exists
+};
+
+} // namespace stel
@@ -0,0 +1,38 @@
+#pragma once
+
+#include <cstddef>
+
+namespace stel {
+
+// Padding/alignment for state written by one thread and read by others.
+// std::hardware_destructive_interference_size would be the natural choice,
+// but its value may change with -mtune/-mcpu, which makes it unsafe to bake
+// into the layout of header-only types. 64 bytes covers x86-64 and most ARM.
+//
+inline constexpr std::size_t cache_line_size = 64;
+
+// Inline storage, in bytes, for Event callbacks. Callables with larger
+// captures do not compile; capture a pointer or raise this instead.
+//
+#ifndef STEL_CALLBACK_CAPACITY
+#define STEL_CALLBACK_CAPACITY 48
+#endif
+
+inline constexpr std::size_t callback_capacity = STEL_CALLBACK_CAPACITY;
+
+// Built-in instrumentation (see event_stats.hpp): publish/delivery counters
+// and per-subscriber callback latency histograms. Off by default, in which
+// case the meters are empty types and cost nothing.
+//
+// It changes the layout of Event, so every translation unit of a program
+// must agree: set it on the build (the STEL_EVENT_STATS CMake option, or
+// -DSTEL_EVENT_STATS=1 for the whole target), never with a #define in a
+// source file.
+//
+#ifndef STEL_EVENT_STATS
+#define STEL_EVENT_STATS 0
+#endif
+
+inline constexpr bool event_stats_enabled = STEL_EVENT_STATS != 0;
+
+} // namespace stel
@@ -0,0 +1,141 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <tuple>
+#include <unordered_map>
+#include <utility>
+#include <variant>
+#include <vector>
+
+#include "config.hpp"
+#include "envelope.hpp"
+#include "error_sink.hpp"
+#include "executor.hpp"
+#include "inplace_function.hpp"
+#include "mailbox.hpp"
+#include "spin_lock.hpp"
+
+namespace stel {
+
+/// ConflatingMailbox<Key, Ts...> delivers only the latest value per key.
+///
+/// - offer(...) overwrites the pending envelope of its key in place, so a
+///   slow subscriber never sees stale intermediate values. Memory is bounded
+///   by the number of distinct keys, whatever the publish rate.
+/// - Key comes from a key function over the payload; Key = std::monostate
+///   (no key function) keeps a single latest value.
+/// - Keys are delivered in the order they first became pending since the
+///   previous drain. Overwritten values are counted as dropped.
+/// - Drain scheduling, error routing and close() work as in Mailbox.
+///
+/// Typical use (through Event):
+///   auto sub = ev->subscribe_latest(on_price, [](const Tick& t) { return t.symbol; });
+
+template <typename Key, typename... Ts>
+class ConflatingMailbox final
+	: public Inbox<Ts...>
+	, public std::enable_shared_from_this<ConflatingMailbox<Key, Ts...>> {
+public:
+	using Handler	= InplaceFunction<void(const Ts&...), callback_capacity>;
+	using KeyFn		= InplaceFunction<Key(const Ts&...), callback_capacity>;
+	using Item		= typename Inbox<Ts...>::Item;
+
+	// Null executor means a dedicated drain thread. Null key keeps a single
+	// latest value (Key must then be default constructible).
+	//
+	ConflatingMailbox(std::shared_ptr<Executor> executor, Handler handler, KeyFn key = nullptr,
+			std::shared_ptr<ErrorSink> errors = nullptr, std::size_t id = 0)
+		: handler_(std::move(handler))
+		, key_(std::move(key))
+		, errors_(std::move(errors))
+		, id_(id)
+		, executor_(executor ? std::move(executor) : std::make_shared<ThreadPoolExecutor>(1)) { }
+
+	ConflatingMailbox(const ConflatingMailbox&)				= delete;
+	ConflatingMailbox& operator =(const ConflatingMailbox&)	= delete;
+
+	bool offer(const Item& env) override {
+		if (!open_.load(std::memory_order_acquire)) return false;
+		Key key = key_ ? std::apply(key_, *env) : Key{};
+		Item replaced;
+		{
+			std::lock_guard<SpinLock> lk(lock_);
+			auto& entry = *latest_.try_emplace(std::move(key)).first;
+			if (entry.second) {
+				conflated_.fetch_add(1, std::memory_order_relaxed);
+			} else {
+				dirty_.push_back(&entry);
+				pending_.fetch_add(1, std::memory_order_relaxed);
+			}
+			replaced = std::exchange(entry.second, env);
+		}
+		schedule();
+		return true;
+	}
+
+	void close() noexcept override { open_.store(false, std::memory_order_release); }
+
+	MailboxStats stats() const noexcept override {
+		return MailboxStats{
+			pending_.load(std::memory_order_relaxed),
+			delivered_.load(std::memory_order_relaxed),
+			conflated_.load(std::memory_order_relaxed),
+		};
+	}
+
+private:
+	using Map = std::unordered_map<Key, Item>;
+
+	void schedule() {
+		// Same handshake as Mailbox: both sides RMW scheduled_.
+		if (!scheduled_.exchange(true, std::memory_order_acq_rel)) {
+			executor_->execute([self = this->shared_from_this()] { self->drain(); });
+		}
+	}
+
+	void drain() {
+		{
+			std::lock_guard<SpinLock> lk(lock_);
+			for (auto* entry : dirty_) {
+				ready_.push_back(std::move(entry->second));
+			}
+			dirty_.clear();
+			pending_.store(0, std::memory_order_relaxed);
+		}
+		for (const Item& item : ready_) {
+			if (!open_.load(std::memory_order_acquire)) break;
+			try {
+				std::apply(handler_, *item);
+			} catch (...) {
+				if (errors_) errors_->report(id_, std::current_exception());
+			}
+			delivered_.fetch_add(1, std::memory_order_relaxed);
+		}
+		ready_.clear();
+		scheduled_.exchange(false, std::memory_order_acq_rel);
+		if (pending_.load(std::memory_order_relaxed) != 0) {
+			schedule();
+		}
+	}
+
+	Handler											handler_;
+	KeyFn											key_;
+	std::shared_ptr<ErrorSink>						errors_;	// Null swallows
+	const std::size_t								id_;
+	std::shared_ptr<Executor>						executor_;
+	std::atomic<bool>								open_{true};
+	alignas(cache_line_size) SpinLock				lock_;
+	Map												latest_;	// Requires lock_; null = delivered
+	std::vector<typename Map::value_type*>			dirty_;		// Requires lock_; entries holding a value
+	std::atomic<std::size_t>						pending_{0};
+	std::atomic<std::uint64_t>						conflated_{0};
+	alignas(cache_line_size) std::atomic<bool>		scheduled_{false};
+	std::vector<Item>								ready_;		// Drain only
+	std::atomic<std::uint64_t>						delivered_{0};
+};
+
+} // namespace stel
@@ -0,0 +1,186 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <thread>
+#include <utility>
+#include <vector>
+
+#include "affinity.hpp"
+#include "config.hpp"
+#include "inplace_function.hpp"
+#include "mpmc_queue.hpp"
+
+namespace stel {
+
+// What publish does when the dispatch queue is full.
+//
+enum class Backpressure {
+	Block,			// Yield until a dispatcher frees a slot
+	DropOldest,		// Discard the oldest queued event to make room
+	DropNewest,		// Discard the event being published
+};
+
+struct AsyncOptions {
+	std::size_t		threads		= 1;
+	std::size_t		capacity	= 1024;	// Rounded up to a power of two
+	Backpressure	policy		= Backpressure::Block;
+	// Worker i runs pinned to cpus[i % cpus.size()]; empty leaves workers to
+	// the scheduler.
+	std::vector<int>	cpus{};
+};
+
+/// AsyncDispatcher<Item> is a fixed pool of threads draining a bounded
+/// MpmcQueue<Item> into a handler.
+///
+/// - post(...) is lock-free and returns as soon as the item is queued.
+/// - Idle workers sleep on an atomic wait, producers only pay for a notify
+///   when somebody is actually sleeping.
+/// - AsyncOptions::cpus pins each worker to one CPU, e.g. the CPUs of one
+///   NUMA node (see CpuTopology).
+/// - The destructor delivers everything still queued, then joins. If it runs
+///   on one of the workers (the handler dropped the last owner), that worker
+///   is detached and exits as soon as the handler returns.
+/// - Item must be default constructible and movable.
+
+template <typename Item>
+class AsyncDispatcher {
+public:
+	using Handler = InplaceFunction<void(Item&)>;
+
+	AsyncDispatcher(const AsyncOptions& opts, Handler handler)
+		: state_(std::make_shared<State>(opts, std::move(handler))) {
+		const std::size_t n = opts.threads == 0 ? 1 : opts.threads;
+		workers_.reserve(n);
+		for (std::size_t i = 0; i < n; i++) {
+			std::vector<int> cpu;
+			if (!opts.cpus.empty()) cpu.push_back(opts.cpus[i % opts.cpus.size()]);
+			workers_.emplace_back([s = state_, cpu = std::move(cpu)] {
+				if (!cpu.empty()) pin_current_thread(cpu);
+				run(*s);
+			});
+		}
+	}
+
+	~AsyncDispatcher() {
+		state_->stop.store(true, std::memory_order_release);
+		state_->wake(true);
+		std::thread* self = nullptr;
+		for (auto& w : workers_) {
+			if (w.get_id() == std::this_thread::get_id()) {
+				self = &w;
+			} else {
+				w.join();
+			}
+		}
+		if (self) {
+			state_->abandoned.store(true, std::memory_order_release);
+			self->detach();
+		}
+	}
+
+	AsyncDispatcher(const AsyncDispatcher&)				= delete;
+	AsyncDispatcher& operator =(const AsyncDispatcher&)	= delete;
+
+	// Queue an item, applying the backpressure policy when full.
+	// Returns false if this item was dropped.
+	//
+	template <typename U>
+	bool post(U&& item) {
+		State& s = *state_;
+		s.outstanding.fetch_add(1, std::memory_order_relaxed);
+		while (!s.queue.try_push(std::forward<U>(item))) {
+			if (s.policy == Backpressure::DropNewest) {
+				s.outstanding.fetch_sub(1, std::memory_order_relaxed);
+				s.dropped.fetch_add(1, std::memory_order_relaxed);
+				return false;
+			}
+			if (s.policy == Backpressure::DropOldest) {
+				Item victim;
+				if (s.queue.try_pop(victim)) {
+					s.outstanding.fetch_sub(1, std::memory_order_relaxed);
+					s.dropped.fetch_add(1, std::memory_order_relaxed);
+				}
+			} else {
+				std::this_thread::yield();
+			}
+		}
+		s.wake(false);
+		return true;
+	}
+
+	// Block until every item posted so far has been handled or dropped.
+	//
+	void flush() const {
+		while (state_->outstanding.load(std::memory_order_acquire) != 0) {
+			std::this_thread::yield();
+		}
+	}
+
+	std::uint64_t dropped() const noexcept { return state_->dropped.load(std::memory_order_relaxed); }
+	std::size_t queued() const noexcept { return state_->queue.size(); }
+	std::size_t threads() const noexcept { return workers_.size(); }
+
+private:
+	// Shared with the workers so a detached worker never touches freed memory.
+	//
+	struct State {
+		State(const AsyncOptions& opts, Handler h)
+			: queue(opts.capacity), handler(std::move(h)), policy(opts.policy) { }
+
+		void wake(bool all) {
+			signal.fetch_add(1);
+			if (sleepers.load() > 0) {
+				all ? signal.notify_all() : signal.notify_one();
+			}
+		}
+
+		MpmcQueue<Item>										queue;
+		Handler												handler;
+		const Backpressure									policy;
+		alignas(cache_line_size) std::atomic<std::uint32_t>	signal{0};
+		std::atomic<std::uint32_t>							sleepers{0};
+		std::atomic<bool>									stop{false};
+		std::atomic<bool>									abandoned{false};
+		alignas(cache_line_size) std::atomic<std::size_t>	outstanding{0};
+		std::atomic<std::uint64_t>							dropped{0};
+	};
+
+	static void run(State& s) {
+		Item item;
+		for (;;) {
+			if (s.abandoned.load(std::memory_order_acquire)) {
+				return;
+			}
+			if (s.queue.try_pop(item)) {
+				handle(s, item);
+				continue;
+			}
+			const std::uint32_t seen = s.signal.load();
+			// Re-check after sampling the signal, a push in between changes it.
+			if (s.queue.try_pop(item)) {
+				handle(s, item);
+				continue;
+			}
+			if (s.stop.load(std::memory_order_acquire)) {
+				return;
+			}
+			s.sleepers.fetch_add(1);
+			s.signal.wait(seen);
+			s.sleepers.fetch_sub(1);
+		}
+	}
+
+	static void handle(State& s, Item& item) {
+		s.handler(item);
+		item = Item{};
+		s.outstanding.fetch_sub(1, std::memory_order_release);
+	}
+
+	std::shared_ptr<State>		state_;
+	std::vector<std::thread>	workers_;
+};
+
+} // namespace stel
@@ -0,0 +1,189 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <new>
+#include <tuple>
+#include <utility>
+
+#include "spin_lock.hpp"
+
+namespace stel {
+
+template <typename... Ts>
+class EnvelopePool;
+
+/// Envelope<Ts...> is one published event: an immutable std::tuple<Ts...>
+/// shared by reference count between every queue that delivers it.
+///
+/// Envelopes come from an EnvelopePool and go back to it when the last
+/// EnvelopePtr is released, so steady-state publishing does not allocate.
+///
+template <typename... Ts>
+class Envelope {
+public:
+	using Payload = std::tuple<Ts...>;
+
+	const Payload& payload() const noexcept {
+		return *std::launder(reinterpret_cast<const Payload*>(storage_));
+	}
+
+private:
+	friend class EnvelopePool<Ts...>;
+	template <typename...> friend class EnvelopePtr;
+
+	std::atomic<std::uint32_t>					refs_{0};
+	EnvelopePool<Ts...>*						pool_ = nullptr;
+	Envelope*									next_free_ = nullptr;
+	alignas(Payload) unsigned char				storage_[sizeof(Payload)];
+};
+
+/// Shared, immutable handle to an Envelope. Copying bumps a reference count,
+/// moving is free. A default constructed EnvelopePtr is null.
+///
+template <typename... Ts>
+class EnvelopePtr {
+public:
+	using Payload = typename Envelope<Ts...>::Payload;
+
+	EnvelopePtr() noexcept = default;
+
+	EnvelopePtr(const EnvelopePtr& other) noexcept : env_(other.env_) {
+		if (env_) env_->refs_.fetch_add(1, std::memory_order_relaxed);
+	}
+
+	EnvelopePtr(EnvelopePtr&& other) noexcept : env_(std::exchange(other.env_, nullptr)) { }
+
+	EnvelopePtr& operator =(EnvelopePtr other) noexcept {
+		std::swap(env_, other.env_);
+		return *this;
+	}
+
+	~EnvelopePtr() { reset(); }
+
+	void reset() noexcept {
+		if (env_ && env_->refs_.fetch_sub(1, std::memory_order_acq_rel) == 1) {
+			env_->pool_->recycle(env_);
+		}
+		env_ = nullptr;
+	}
+
+	const Payload& operator *() const noexcept { return env_->payload(); }
+	const Payload* operator ->() const noexcept { return &env_->payload(); }
+
+	explicit operator bool() const noexcept { return env_ != nullptr; }
+
+	std::uint32_t use_count() const noexcept {
+		return env_ ? env_->refs_.load(std::memory_order_relaxed) : 0;
+	}
+
+private:
+	friend class EnvelopePool<Ts...>;
+	explicit EnvelopePtr(Envelope<Ts...>* env) noexcept : env_(env) { }
+
+	Envelope<Ts...>* env_ = nullptr;
+};
+
+/// EnvelopePool<Ts...> recycles Envelopes.
+///
+/// - make(...) pops a free envelope (or allocates one) and constructs the
+///   payload in place, moving from rvalue arguments.
+/// - The pool is reference counted by its owner and by every outstanding
+///   envelope, so envelopes still sitting in a queue may safely outlive the
+///   Event that created them.
+/// - At most max_cached free envelopes are kept, the rest are freed.
+///
+template <typename... Ts>
+class EnvelopePool {
+	struct Release {
+		void operator ()(EnvelopePool* pool) const noexcept { pool->unref(); }
+	};
+
+public:
+	using Owner = std::unique_ptr<EnvelopePool, Release>;
+
+	static constexpr std::size_t kDefaultCached = 1024;
+
+	static Owner create(std::size_t max_cached = kDefaultCached) {
+		return Owner(new EnvelopePool(max_cached));
+	}
+
+	EnvelopePool(const EnvelopePool&)				= delete;
+	EnvelopePool& operator =(const EnvelopePool&)	= delete;
+
+	template <typename... Us>
+	EnvelopePtr<Ts...> make(Us&&... args) {
+		Envelope<Ts...>* env = pop();
+		if (!env) {
+			env = new Envelope<Ts...>();
+			env->pool_ = this;
+		}
+		try {
+			::new (static_cast<void*>(env->storage_)) std::tuple<Ts...>(std::forward<Us>(args)...);
+		} catch (...) {
+			push(env);
+			throw;
+		}
+		env->refs_.store(1, std::memory_order_relaxed);
+		refs_.fetch_add(1, std::memory_order_relaxed);
+		return EnvelopePtr<Ts...>(env);
+	}
+
+	std::size_t cached() const noexcept { return cached_.load(std::memory_order_relaxed); }
+
+private:
+	template <typename...> friend class EnvelopePtr;
+
+	explicit EnvelopePool(std::size_t max_cached) : max_cached_(max_cached) { }
+
+	~EnvelopePool() {
+		while (free_) {
+			delete std::exchange(free_, free_->next_free_);
+		}
+	}
+
+	void recycle(Envelope<Ts...>* env) noexcept {
+		using Payload = std::tuple<Ts...>;
+		std::launder(reinterpret_cast<Payload*>(env->storage_))->~Payload();
+		if (cached_.load(std::memory_order_relaxed) < max_cached_) {
+			push(env);
+		} else {
+			delete env;
+		}
+		unref();
+	}
+
+	Envelope<Ts...>* pop() noexcept {
+		std::lock_guard<SpinLock> lk(lock_);
+		Envelope<Ts...>* env = free_;
+		if (env) {
+			free_ = env->next_free_;
+			cached_.fetch_sub(1, std::memory_order_relaxed);
+		}
+		return env;
+	}
+
+	void push(Envelope<Ts...>* env) noexcept {
+		std::lock_guard<SpinLock> lk(lock_);
+		env->next_free_ = free_;
+		free_ = env;
+		cached_.fetch_add(1, std::memory_order_relaxed);
+	}
+
+	void unref() noexcept {
+		if (refs_.fetch_sub(1, std::memory_order_acq_rel) == 1) {
+			delete this;
+		}
+	}
+
+	const std::size_t			max_cached_;
+	std::atomic<std::size_t>	refs_{1};		// Owner + outstanding envelopes
+	std::atomic<std::size_t>	cached_{0};
+	SpinLock					lock_;
+	Envelope<Ts...>*			free_ = nullptr;	// Requires lock_
+};
+
+} // namespace stel
@@ -0,0 +1,222 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <mutex>
+#include <utility>
+#include <vector>
+
+#include "config.hpp"
+
+namespace stel {
+
+/// EpochDomain is a process-wide epoch-based reclamation (EBR) domain.
+///
+/// - Readers bracket access to shared snapshots with an EpochGuard. Pinning
+///   only writes the calling thread's own cache-line sized record, so readers
+///   never write a shared counter and scale with the number of cores.
+/// - Writers unlink an object first and then retire() it. A retired object is
+///   destroyed once the global epoch has advanced twice past the retire point,
+///   i.e. once every reader that could still observe it has unpinned.
+/// - Reclamation runs on the thread calling retire()/collect(), which in
+///   practice is the writer, never a publisher: a retire() from a pinned
+///   thread (say a subscriber unsubscribing from inside publish) only
+///   queues, and the next unpinned retire() or collect() frees.
+///
+/// Guards nest: a callback that publishes another Event re-enters cheaply.
+///
+/// Typical use:
+///   {
+///       EpochGuard g;
+///       auto* snap = ptr.load(std::memory_order_acquire);
+///       // ... read *snap ...
+///   }
+///   auto* old = ptr.exchange(next, std::memory_order_acq_rel);
+///   EpochDomain::instance().retire(old);
+
+class EpochDomain {
+public:
+	using Deleter = void (*)(void*);
+
+	static EpochDomain& instance() noexcept {
+		static EpochDomain domain;
+		return domain;
+	}
+
+	EpochDomain(const EpochDomain&)				= delete;
+	EpochDomain& operator =(const EpochDomain&)	= delete;
+
+	~EpochDomain() {
+		for (auto& r : retired_) {
+			r.deleter(r.ptr);
+		}
+		Record* rec = records_.load(std::memory_order_acquire);
+		while (rec) {
+			delete std::exchange(rec, rec->next);
+		}
+	}
+
+	// Pin the calling thread to the current epoch.
+	//
+	void enter() noexcept {
+		Record* rec = local_record();
+		if (rec->depth++ == 0) {
+			rec->epoch.store(global_.load(std::memory_order_relaxed), std::memory_order_relaxed);
+			// Pairs with the fence in retire(): either the writer sees this pin,
+			// or this thread sees the writer's unlink.
+			std::atomic_thread_fence(std::memory_order_seq_cst);
+		}
+	}
+
+	void exit() noexcept {
+		Record* rec = local_record();
+		if (--rec->depth == 0) {
+			rec->epoch.store(kQuiescent, std::memory_order_release);
+		}
+	}
+
+	// True while the calling thread holds an EpochGuard.
+	//
+	bool pinned() noexcept { return local_record()->depth > 0; }
+
+	// Hand an already unlinked object over for deferred destruction.
+	//
+	void retire(void* ptr, Deleter deleter) {
+		std::atomic_thread_fence(std::memory_order_seq_cst);
+		const std::uint64_t epoch = global_.load(std::memory_order_relaxed);
+		{
+			std::lock_guard<std::mutex> lk(retired_mtx_);
+			retired_.push_back(Retired{ptr, deleter, epoch});
+		}
+		if (!pinned()) collect();
+	}
+
+	template <typename T>
+	void retire(T* ptr) {
+		retire(ptr, [](void* p) { delete static_cast<T*>(p); });
+	}
+
+	// Try to advance the epoch and destroy everything no reader can reach.
+	//
+	void collect() {
+		std::vector<Retired> ready;
+		{
+			std::lock_guard<std::mutex> lk(retired_mtx_);
+			if (retired_.empty()) return;
+
+			// Two advances make objects retired in the current epoch reclaimable
+			// right away when no reader is pinned.
+			std::uint64_t epoch = global_.load(std::memory_order_relaxed);
+			for (int i = 0; i < 2 && try_advance(epoch); i++) {
+				++epoch;
+			}
+
+			auto keep = retired_.begin();
+			for (auto& r : retired_) {
+				if (r.epoch + 2 <= epoch) {
+					ready.push_back(r);
+				} else {
+					*keep++ = r;
+				}
+			}
+			retired_.erase(keep, retired_.end());
+		}
+
+		// Run deleters without the lock, they may retire more objects.
+		for (auto& r : ready) {
+			r.deleter(r.ptr);
+		}
+	}
+
+	std::size_t pending() const {
+		std::lock_guard<std::mutex> lk(retired_mtx_);
+		return retired_.size();
+	}
+
+private:
+	static constexpr std::uint64_t kQuiescent = 0;
+
+	struct alignas(cache_line_size) Record {
+		std::atomic<std::uint64_t>	epoch{kQuiescent};
+		std::atomic<bool>			in_use{true};
+		unsigned					depth = 0; // Only touched by the owning thread
+		Record*						next = nullptr;
+	};
+
+	struct Retired {
+		void*			ptr;
+		Deleter			deleter;
+		std::uint64_t	epoch;
+	};
+
+	// Releases the thread's record for reuse when the thread exits.
+	//
+	struct ThreadRecord {
+		Record* rec = nullptr;
+		~ThreadRecord() {
+			if (rec) {
+				rec->epoch.store(kQuiescent, std::memory_order_relaxed);
+				rec->in_use.store(false, std::memory_order_release);
+			}
+		}
+	};
+
+	EpochDomain() = default;
+
+	static Record* local_record() noexcept {
+		thread_local ThreadRecord tr;
+		if (!tr.rec) [[unlikely]] {
+			tr.rec = instance().acquire_record();
+		}
+		return tr.rec;
+	}
+
+	Record* acquire_record() {
+		for (Record* r = records_.load(std::memory_order_acquire); r; r = r->next) {
+			bool expected = false;
+			if (!r->in_use.load(std::memory_order_relaxed) &&
+					r->in_use.compare_exchange_strong(expected, true, std::memory_order_acquire)) {
+				return r;
+			}
+		}
+		auto* r = new Record();
+		r->next = records_.load(std::memory_order_relaxed);
+		while (!records_.compare_exchange_weak(r->next, r,
+					std::memory_order_release, std::memory_order_relaxed)) { }
+		return r;
+	}
+
+	// The epoch may move forward only when every pinned thread has observed it.
+	// Called with retired_mtx_ held, so there is a single advancer.
+	//
+	bool try_advance(std::uint64_t epoch) noexcept {
+		std::atomic_thread_fence(std::memory_order_seq_cst);
+		for (Record* r = records_.load(std::memory_order_acquire); r; r = r->next) {
+			const std::uint64_t e = r->epoch.load(std::memory_order_acquire);
+			if (e != kQuiescent && e != epoch) {
+				return false;
+			}
+		}
+		global_.store(epoch + 1, std::memory_order_seq_cst);
+		return true;
+	}
+
+	alignas(cache_line_size) std::atomic<std::uint64_t>	global_{1};
+	alignas(cache_line_size) std::atomic<Record*>		records_{nullptr};
+	mutable std::mutex									retired_mtx_;
+	std::vector<Retired>								retired_;
+};
+
+/// RAII pin on the process-wide EpochDomain.
+///
+class EpochGuard {
+public:
+	EpochGuard() noexcept { EpochDomain::instance().enter(); }
+	~EpochGuard() { EpochDomain::instance().exit(); }
+
+	EpochGuard(const EpochGuard&)				= delete;
+	EpochGuard& operator =(const EpochGuard&)	= delete;
+};
+
+} // namespace stel
@@ -0,0 +1,65 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <exception>
+#include <memory>
+#include <mutex>
+#include <utility>
+
+#include "inplace_function.hpp"
+
+namespace stel {
+
+// Receives the ID of the subscription whose callback threw, and what it threw.
+//
+using ErrorHandler = InplaceFunction<void(std::size_t, std::exception_ptr)>;
+
+/// ErrorSink collects exceptions escaping subscriber callbacks.
+///
+/// - report(...) counts the failure and forwards it to the installed handler,
+///   if any; with no handler the exception is swallowed but still counted.
+/// - set(...) may be called at any time, concurrently with report(). A
+///   handler that is being replaced finishes its current call first.
+/// - report(...) never throws: exceptions thrown by the handler itself, or
+///   by the lock guarding it, are swallowed (the failure is still counted).
+///
+/// Typical use:
+///   sink.set([](std::size_t id, std::exception_ptr e) { log(id, e); });
+///   ...
+///   if (sink.failures() > 0) { ... }
+///
+class ErrorSink {
+public:
+	void set(ErrorHandler handler) {
+		auto next = handler ? std::make_shared<ErrorHandler>(std::move(handler)) : nullptr;
+		std::lock_guard<std::mutex> lk(m_);
+		handler_ = std::move(next);
+	}
+
+	// Runs in a publisher's catch block, on behalf of a subscriber, so it
+	// must not throw in turn.
+	//
+	void report(std::size_t id, std::exception_ptr error) noexcept {
+		failures_.fetch_add(1, std::memory_order_relaxed);
+		try {
+			std::shared_ptr<ErrorHandler> handler;
+			{
+				std::lock_guard<std::mutex> lk(m_);
+				handler = handler_;
+			}
+			if (handler) (*handler)(id, std::move(error));
+		} catch (...) {
+		}
+	}
+
+	std::uint64_t failures() const noexcept { return failures_.load(std::memory_order_relaxed); }
+
+private:
+	std::atomic<std::uint64_t>		failures_{0};
+	std::mutex						m_;
+	std::shared_ptr<ErrorHandler>	handler_;	// Requires m_
+};
+
+} // namespace stel
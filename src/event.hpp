@@ -1,13 +1,42 @@
 #pragma once 
 
+#include <algorithm>
 #include <atomic>
 #include <vector>
+#include <concepts>
 #include <cstddef>
+#include <cstdint>
+#include <exception>
 #include <functional>
+#include <map>
 #include <memory>
 #include <mutex>
+#include <ranges>
+#include <span>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <tuple>
 #include <utility>
 #include <unordered_map>
+#include <variant>
+
+#include "config.hpp"
+#include "conflating_mailbox.hpp"
+#include "dispatcher.hpp"
+#include "envelope.hpp"
+#include "epoch.hpp"
+#include "error_sink.hpp"
+#include "event_stats.hpp"
+#include "fanout_pool.hpp"
+#include "inplace_function.hpp"
+#include "journal.hpp"
+#include "key_filter.hpp"
+#include "mailbox.hpp"
+#include "spin_lock.hpp"
+#include "stream_inbox.hpp"
+#include "topic_map.hpp"
+#include "topic_trie.hpp"
 
 namespace stel {
 
@@ -15,43 +44,145 @@ namespace stel {
 ///		void(const Ts&...);
 ///
 ///	- publish(...) is a lock-free with respect to other publisher/subscribers:
-///	  it holds a snapshot of the current subscriber list and calls them.
+///	  it pins the current epoch, reads the snapshot of the subscriber list
+///	  and calls them. No shared counter is written on this path.
 /// - subscribe/unsubscribe are copy-on-write (small mutex), safe to call 
 ///   concurrently with publish and with each other.
-/// - RAII subscription token automatically unsubscribe on destruction.
+/// - unsubscribe is O(1): the slot is tombstoned and the snapshot compacted
+///   lazily, at the next subscribe or once tombstones outnumber live slots.
+/// - Replaced snapshots are retired to the EpochDomain and freed by writers
+///   once every publisher that could still see them has finished. Threads
+///   inside publish() never free them: subscription changes made from a
+///   callback only queue their garbage, and compaction waits for the next
+///   writer outside a publish. Queued payloads are the exception, they are
+///   recycled by whichever thread drops the last envelope reference.
+/// - RAII subscription token automatically unsubscribe on destruction. The
+///   token is a counted slot pointer: releasing it takes no lock, and the
+///   Event catches up on its next write. SubscriptionGroup drops many
+///   tokens with one snapshot rebuild per Event.
+/// - Per-subscriber mailboxes: subscribe(cb, MailboxOptions) gives that one
+///   subscriber its own bounded SPSC queue and executor, so a slow consumer
+///   only ever delays itself. subscribe_latest(cb[, key]) conflates instead:
+///   pending values are overwritten, one per subscriber (or per key).
+/// - Optionally asynchronous: constructed with AsyncOptions, publish wraps the
+///   arguments into a bounded lock-free queue and returns; a per-Event pool of
+///   dispatcher threads runs the subscribers.
+/// - Queued deliveries share one pooled, immutable Envelope per event, so
+///   payloads are copied (or, with publish(Ts&&...), moved) exactly once.
+/// - Callbacks are move-only InplaceFunctions stored inline in a per-subscriber
+///   slot that never moves; snapshots are contiguous arrays of slot pointers,
+///   so copy-on-write copies pointers, never callables.
+/// - subscribe(cb, priority): the snapshot is kept sorted by priority at write
+///   time (stable, higher first), so publish remains a plain linear scan.
+/// - subscribe(key_of(proj).is(k), cb) indexes the subscriber by key: publish
+///   projects each event once per projection and only calls that key's
+///   subscribers instead of every filtering callback.
+/// - publish_batch(span) loads the snapshot once for a whole span of events;
+///   subscribe_batch(cb) subscribers receive the span in a single call.
+/// - Coroutines: co_await ev->next() waits for one event, ev->stream() keeps
+///   a queued subscription whose next() is awaited in a loop. The consumer
+///   is resumed inline by the publisher (or on an Executor) straight from
+///   the mailbox push, no callback in between.
+/// - Broadcast Events constructed with a FanoutPool split large snapshots
+///   into chunks that the publisher and the pool's helpers run in parallel.
+/// - Built with STEL_EVENT_STATS, stats() reports publish/delivery counters
+///   (sharded per thread) and each subscriber's callback latency histogram.
 ///
 /// Typical use:
 ///   auto ev = std::make_shared<Event<std::string>>();
 ///   auto sub = ev->subscribe([](const std::string& s) { std::puts(s.c_str()); });
 ///   ev->publish("hello");
 
+template <typename... Ts>
+class SubscriptionGroup;
+
 template <typename... Ts>
 class Event : public std::enable_shared_from_this<Event<Ts...>> {
 public:
-	using Callback = std::function<void(const Ts&...)>;
+	using Callback = InplaceFunction<void(const Ts&...), callback_capacity>;
+
+	using Batch			= std::span<const std::tuple<Ts...>>;
+	using BatchCallback	= InplaceFunction<void(Batch), callback_capacity>;
+
+private:
+	struct Slot;
+	struct Tally;
+
+	friend class SubscriptionGroup<Ts...>;
+
+public:
 
 	Event()
-		: slots_(std::make_shared<SlotVec>())
-		, next_id_(1) { }
+		: tally_(new Tally())
+		, next_id_(1)
+		, snapshots_(new SnapshotPool()) {
+		// Make sure the domain outlives Events with static storage duration.
+		EpochDomain::instance();
+		slots_.store(snapshots_->acquire(), std::memory_order_relaxed);
+	}
+
+	// Asynchronous Event: publish enqueues and returns immediately.
+	// Subscribers of an async Event must not drop its last reference.
+	//
+	explicit Event(const AsyncOptions& opts)
+		: Event() {
+		tally_->pool = Pool::create();
+		dispatcher_ = std::make_unique<Dispatcher>(opts, [this](Envelope& env) {
+			std::apply([&](const Ts&... args) { dispatch(env, args...); }, *env);
+		});
+	}
+
+	// Parallel fan-out: publish splits snapshots larger than one chunk
+	// across pool (shared between Events), with the publisher taking part
+	// and returning once every chunk is done. Subscribers of one event then
+	// run concurrently, in priority order only within a chunk.
+	//
+	explicit Event(std::shared_ptr<FanoutPool> pool)
+		: Event() {
+		tally_->fanout = std::move(pool);
+	}
+
+	~Event() {
+		// Deliver what is still queued while the slots are alive.
+		dispatcher_.reset();
+
+		// Tokens outliving us stop here instead of releasing their slot.
+		tally_->closed.store(true, std::memory_order_release);
+
+		// Let queued subscribers that wait on us, like streams, finish.
+		if (tally_->mailboxes.load(std::memory_order_acquire) != 0) {
+			for (Slot* slot : *slots_.load(std::memory_order_relaxed)) {
+				if (slot->mailbox && slot->live.load(std::memory_order_relaxed)) slot->mailbox->finish();
+			}
+		}
+
+		// A subscriber may drop the last reference from inside publish(),
+		// so even the final snapshot goes through the domain.
+		EpochDomain::instance().retire(slots_.load(std::memory_order_relaxed), &destroy_all);
+		snapshots_->unref();
+		tally_->unref();
+	}
 
 	Event(const Event&)				= delete;
 	Event& operator =(const Event&) = delete;
 
+	// RAII token: a counted reference to the subscriber's slot, one pointer
+	// wide. Releasing it clears the slot's live flag and bumps a counter the
+	// Event folds in on its next write; it takes no lock and does not touch
+	// the Event itself, except for the one release in many that finds
+	// enough tombstones to be worth compacting.
+	//
 	class Subscription {
 	public:
 		Subscription() = default;
-		~Subscription() { unsubscribe(); }
+		~Subscription() { release(true); }
 
-		Subscription(Subscription&& other) noexcept 
-			: owner_(std::exchange(other.owner_, nullptr)), id_(std::exchange(other.id_, 0))
-		{ }
+		Subscription(Subscription&& other) noexcept : slot_(std::exchange(other.slot_, nullptr)) { }
 
 		Subscription& operator =(Subscription&& other) noexcept {
 			if (this != &other) {
-				unsubscribe();
-				owner_ = std::move(other.owner_);
-				id_ = other.id_;
-				other.id_ = 0;
+				release(true);
+				slot_ = std::exchange(other.slot_, nullptr);
 			}
 			return *this;
 		}
@@ -59,140 +190,1635 @@ public:
 		Subscription(const Subscription&)				= delete;
 		Subscription& operator =(const Subscription&)	= delete;
 
-		bool unsubscribe() {
-			auto ev = owner_.lock();
-			if (!ev || id_ == 0) return false;
-			bool removed = ev->unsubscribe(id_);
-			id_ = 0;
-			owner_.reset();
+		// False if already unsubscribed, by ID or clear(), or if the Event
+		// is gone.
+		//
+		bool unsubscribe() { return release(true); }
+
+		explicit operator bool() const noexcept { return slot_ != nullptr; }
+
+		std::size_t id() const noexcept { return slot_ ? slot_->id : 0; }
+
+	private:
+		friend class Event<Ts...>;
+		friend class SubscriptionGroup<Ts...>;
+
+		explicit Subscription(Slot* slot) noexcept : slot_(slot) { }	// Adopts a reference
+
+		bool release(bool compact) {
+			Slot* slot = std::exchange(slot_, nullptr);
+			if (!slot) return false;
+			Tally* tally = slot->tally;
+			const bool removed = !tally->closed.load(std::memory_order_acquire)
+					&& slot->live.exchange(false, std::memory_order_acq_rel);
+			// Inside a publish (a callback dropping a token) nothing is
+			// compacted or freed here; the next writer picks it up.
+			const bool publishing = EpochDomain::instance().pinned();
+			if (removed) {
+				tally->release(*slot);
+				const std::size_t n = tally->tombstones.fetch_add(1, std::memory_order_relaxed) + 1;
+				if (compact && !publishing && n >= tally->compact_at.load(std::memory_order_relaxed)) {
+					if (auto ev = tally->owner.lock()) ev->purge(false);
+				}
+			}
+			if (publishing) {
+				EpochDomain::instance().retire(slot, [](void* p) { Slot::unref(static_cast<Slot*>(p)); });
+			} else {
+				Slot::unref(slot);
+			}
 			return removed;
 		}
 
-		explicit operator bool() const noexcept { return id_ != 0; }
+		Slot* slot_ = nullptr;
+	}; // class Subscription
+
+	// A queued subscription read by a coroutine, see stream(). Movable;
+	// destroying it unsubscribes, so it must not be awaited at that point.
+	//
+	class Stream {
+	public:
+		Stream() = default;
+		~Stream() { detach(); }
+
+		Stream(Stream&&) noexcept = default;
+
+		Stream& operator =(Stream&& other) noexcept {
+			if (this != &other) {
+				detach();
+				sub_ = std::move(other.sub_);
+				inbox_ = std::move(other.inbox_);
+			}
+			return *this;
+		}
+
+		// Awaitable yielding the next event as an EnvelopePtr, null once
+		// the stream has ended.
+		//
+		[[nodiscard]] typename StreamInbox<Ts...>::Next next() noexcept { return inbox_->next(); }
+
+		MailboxStats stats() const noexcept { return inbox_->stats(); }
+
+		Subscription& subscription() noexcept { return sub_; }
+
+		explicit operator bool() const noexcept { return static_cast<bool>(sub_); }
 
 	private:
 		friend class Event<Ts...>;
-		Subscription(std::weak_ptr<Event> owner, std::size_t id)
-			: owner_(std::move(owner)), id_(id) { }
-		std::weak_ptr<Event> owner_;
-		std::size_t id_ = 0;
-	}; // class Subscription
+		Stream(Subscription sub, std::shared_ptr<StreamInbox<Ts...>> inbox) noexcept
+			: sub_(std::move(sub)), inbox_(std::move(inbox)) { }
+
+		// Forget a coroutine still parked on us (its frame may be gone)
+		// before unsubscribing would resume it.
+		void detach() noexcept {
+			if (inbox_) inbox_->detach();
+			sub_ = Subscription{};
+		}
+
+		Subscription						sub_;
+		std::shared_ptr<StreamInbox<Ts...>>	inbox_;
+	}; // class Stream
+
+	// Awaitable for the first event published after next() was called; the
+	// one-shot subscriber is dropped with the awaitable.
+	//
+	// Typical use:
+	//   auto e = co_await ev->next();
+	//
+	class NextEvent {
+	public:
+		bool await_ready() { return next_.await_ready(); }
+		bool await_suspend(std::coroutine_handle<> h) { return next_.await_suspend(h); }
+		EnvelopePtr<Ts...> await_resume() { return next_.await_resume(); }
+
+	private:
+		friend class Event<Ts...>;
+		explicit NextEvent(Stream stream) noexcept : stream_(std::move(stream)), next_(stream_.next()) { }
+
+		Stream								stream_;
+		typename StreamInbox<Ts...>::Next	next_;
+	}; // class NextEvent
+
+	// Stages adds and removes and applies them with a single snapshot
+	// rebuild on commit(). Dropping an uncommitted Transaction discards it.
+	//
+	// Typical use:
+	//   auto tx = ev->transaction();
+	//   for (auto& h : handlers) tx.subscribe(h);
+	//   tx.unsubscribe(std::move(old_sub));
+	//   auto subs = tx.commit();
+	//
+	class Transaction {
+	public:
+		Transaction(Transaction&&) noexcept				= default;
+		Transaction& operator =(Transaction&&) noexcept	= default;
+
+		// Stage a subscriber. Returns its position in the vector returned
+		// by commit().
+		//
+		template <typename F>
+			requires std::constructible_from<Callback, F>
+		std::size_t subscribe(F&& cb, int priority = 0) {
+			adds_.push_back(owner_->make_slot(std::forward<F>(cb), priority));
+			return adds_.size() - 1;
+		}
+
+		void unsubscribe(std::size_t id) { removes_.push_back(id); }
+
+		// Take over a token of this Event, its subscriber is removed on commit.
+		// Tokens of other Events are simply unsubscribed right away.
+		//
+		void unsubscribe(Subscription&& sub) {
+			if (!sub || sub.slot_->tally != owner_->tally_) {
+				sub.unsubscribe();
+				return;
+			}
+			removes_.push_back(sub.slot_->id);
+			Slot::unref(std::exchange(sub.slot_, nullptr));
+		}
+
+		[[nodiscard]] std::vector<Subscription> commit() {
+			std::vector<Subscription> subs;
+			subs.reserve(adds_.size());
+			std::vector<Slot*> added;
+			added.reserve(adds_.size());
+			for (auto& slot : adds_) {
+				slot->ref();
+				added.push_back(slot.get());
+			}
+			owner_->apply(adds_, removes_);
+			for (Slot* slot : added) {
+				subs.push_back(Subscription{slot});
+			}
+			adds_.clear();
+			removes_.clear();
+			return subs;
+		}
+
+		bool empty() const noexcept { return adds_.empty() && removes_.empty(); }
+
+	private:
+		friend class Event<Ts...>;
+		explicit Transaction(std::shared_ptr<Event> owner) : owner_(std::move(owner)) { }
+
+		std::shared_ptr<Event>				owner_;
+		std::vector<std::unique_ptr<Slot>>	adds_;
+		std::vector<std::size_t>			removes_;
+	}; // class Transaction
+
+	[[nodiscard]] Transaction transaction() { return Transaction{this->shared_from_this()}; }
 
 	// Add a subscriber.
 	// Returns RAII Token, destroying it unsubscribes.
+	// Callables declared noexcept are invoked without a try block.
+	// Higher priorities run first, equal ones in subscription order.
+	//
+	template <typename F>
+		requires std::constructible_from<Callback, F>
+	[[nodiscard]] Subscription subscribe(F&& cb, int priority = 0) {
+		return add(make_slot(std::forward<F>(cb), priority));
+	}
+
+	// Add a subscriber that only sees events whose projected key equals the
+	// filter's, see KeyProjection. Subscribers of one projection share a hash
+	// index that publish probes once, so publish costs O(matching) rather
+	// than O(subscribers). priority orders subscribers of the same key; the
+	// index itself runs at priority 0 among unfiltered subscribers.
+	//
+	template <typename Proj, typename V, typename F>
+		requires std::is_invocable_v<const Proj&, const Ts&...> && std::constructible_from<Callback, F>
+	[[nodiscard]] Subscription subscribe(const KeyFilter<Proj, V>& filter, F&& cb, int priority = 0) {
+		std::lock_guard<std::mutex> lk(filter_mtx_);
+		return route(filter)->subscribe(std::forward<F>(cb), priority);
+	}
+
+	// Add a subscriber that is delivered through its own mailbox: publish only
+	// enqueues, and the mailbox's executor runs cb.
 	//
-	[[nodiscard]] Subscription subscribe(Callback cb) {
+	[[nodiscard]] Subscription subscribe(Callback cb, const MailboxOptions& opts) {
+		return add_inbox([&](std::size_t id) {
+			return std::make_shared<Mailbox<Ts...>>(opts, std::move(cb), tally_->errors, id);
+		});
+	}
+
+	// Add a queued subscriber with its own Inbox implementation (a Journal,
+	// a bridge, ...). Publish offers it the shared envelope of each event;
+	// removing the subscriber closes it.
+	//
+	[[nodiscard]] Subscription subscribe(std::shared_ptr<Inbox<Ts...>> inbox) {
+		if (!inbox) throw std::invalid_argument("Event::subscribe: null inbox");
+		return add_inbox([&](std::size_t) { return std::move(inbox); });
+	}
+
+	// Add a conflating subscriber: values published while cb is still busy
+	// replace the pending one instead of queueing behind it, so cb always
+	// gets the latest value. Null executor means a dedicated thread.
+	//
+	[[nodiscard]] Subscription subscribe_latest(Callback cb, std::shared_ptr<Executor> executor = nullptr) {
+		return add_inbox([&](std::size_t id) {
+			return std::make_shared<ConflatingMailbox<std::monostate, Ts...>>(
+					std::move(executor), std::move(cb), nullptr, tally_->errors, id);
+		});
+	}
+
+	// Conflating subscriber keeping the latest value per key(args...), e.g.
+	// per instrument on a price topic.
+	//
+	template <typename KeyFn>
+		requires std::is_invocable_v<KeyFn&, const Ts&...>
+	[[nodiscard]] Subscription subscribe_latest(Callback cb, KeyFn&& key,
+			std::shared_ptr<Executor> executor = nullptr) {
+		using Key = std::decay_t<std::invoke_result_t<KeyFn&, const Ts&...>>;
+		using Conflator = ConflatingMailbox<Key, Ts...>;
+		return add_inbox([&](std::size_t id) {
+			return std::make_shared<Conflator>(std::move(executor), std::move(cb),
+					typename Conflator::KeyFn(std::forward<KeyFn>(key)), tally_->errors, id);
+		});
+	}
+
+	// Add a subscriber read by a coroutine: publish queues a shared envelope
+	// and resumes the awaiting coroutine, if any, inline or on
+	// opts.executor.
+	//
+	// Typical use:
+	//   auto events = ev->stream();
+	//   while (auto e = co_await events.next()) { ... }
+	//
+	[[nodiscard]] Stream stream(const StreamOptions& opts = {}) {
+		std::shared_ptr<StreamInbox<Ts...>> inbox;
+		Subscription sub = add_inbox([&](std::size_t) {
+			inbox = std::make_shared<StreamInbox<Ts...>>(opts);
+			return inbox;
+		});
+		return Stream{std::move(sub), std::move(inbox)};
+	}
+
+	// co_await ev->next() resumes with the next event. The subscriber exists
+	// from this call on, so nothing published before the co_await is lost.
+	//
+	[[nodiscard]] NextEvent next(std::shared_ptr<Executor> executor = nullptr) {
+		return NextEvent{stream(StreamOptions{2, Backpressure::DropNewest, std::move(executor)})};
+	}
+
+	// Add a subscriber receiving events as spans: all of a publish_batch()
+	// at once, or a span of one for publish().
+	//
+	template <typename F>
+		requires std::constructible_from<BatchCallback, F>
+	[[nodiscard]] Subscription subscribe_batch(F&& cb) {
+		constexpr bool nothrow = std::is_nothrow_invocable_v<std::decay_t<F>&, Batch>;
 		const std::size_t id = next_id_.fetch_add(1, std::memory_order_relaxed);
+		auto slot = std::make_unique<Slot>(tally_, id, nullptr, nothrow);
+		slot->batch = std::make_unique<BatchCallback>(std::forward<F>(cb));
+		{
+			// Single publishes hand batch subscribers a pooled envelope.
+			std::lock_guard<std::mutex> lk(write_mtx_);
+			if (!tally_->pool) tally_->pool = Pool::create();
+		}
+		return add(std::move(slot));
+	}
 
-		// Copy-on-write update of the slot vector.
-		//
+	// Queue depth and counters of a mailbox subscriber, zeros otherwise.
+	//
+	MailboxStats mailbox_stats(std::size_t id) const {
 		std::lock_guard<std::mutex> lk(write_mtx_);
-		auto curr = slots_.load(std::memory_order_acquire); 
-		auto next = std::make_shared<SlotVec>(*curr);
-		next->emplace_back(id, std::move(cb));
-		slots_.store(std::move(next), std::memory_order_release);
+		auto it = index_.find(id);
+		return it != index_.end() && it->second->mailbox && it->second->live.load(std::memory_order_relaxed)
+				? it->second->mailbox->stats() : MailboxStats{};
+	}
 
-		return Subscription{this->weak_from_this(), id};
+	// Add every callback of a range with a single snapshot rebuild.
+	// Callbacks are moved out of rvalue ranges and copied from lvalue ones,
+	// so an lvalue range must hold copyable callables (not Callback, which
+	// is move-only: pass such a range with std::move).
+	//
+	template <std::ranges::input_range R>
+		requires std::constructible_from<Callback, std::conditional_t<std::is_lvalue_reference_v<R>,
+				std::ranges::range_reference_t<R>, std::ranges::range_rvalue_reference_t<R>>>
+	[[nodiscard]] std::vector<Subscription> subscribe_many(R&& callbacks) {
+		auto tx = transaction();
+		for (auto&& cb : callbacks) {
+			if constexpr (std::is_lvalue_reference_v<R>) {
+				tx.subscribe(cb);
+			} else {
+				tx.subscribe(std::move(cb));
+			}
+		}
+		return tx.commit();
 	}
 
-	// Manually unsubscribe by ID (normally handled by Subscription)
+	// Manually unsubscribe by ID (normally handled by Subscription).
+	// O(1): the slot is tombstoned in place and skipped by publish; the
+	// snapshot is compacted lazily once tombstones outnumber live slots.
 	//
 	bool unsubscribe(std::size_t id) {
 		std::lock_guard<std::mutex> lk(write_mtx_);
-		auto curr = slots_.load(std::memory_order_acquire);
-		auto next = std::make_shared<SlotVec>();
-		next->reserve(curr->size());
-		bool removed = false;
-		// TODO: Is there move efficient way doing this?
-		//
-		for (auto& [sid, fn] : *curr) {
-			if (sid == id) {
-				removed = true;
-			} else {
-				next->emplace_back(sid, fn);
+		reconcile();
+		const bool removed = tombstone(id);
+		maybe_compact();
+		return removed;
+	}
+
+	// Unsubscribe many IDs with at most one snapshot rebuild.
+	// Returns the number of subscribers removed.
+	//
+	std::size_t unsubscribe(std::span<const std::size_t> ids) {
+		std::lock_guard<std::mutex> lk(write_mtx_);
+		reconcile();
+		std::size_t removed = 0;
+		for (std::size_t id : ids) {
+			removed += tombstone(id);
+		}
+		maybe_compact();
+		return removed;
+	}
+
+	// Publish an event to all current subscribers, or queue it for the
+	// dispatcher threads of an async Event.
+	//
+	void publish(const Ts&... args) const {
+		if (dispatcher_) {
+			dispatcher_->post(tally_->pool->make(args...));
+			return;
+		}
+		Envelope env;
+		dispatch(env, args...);
+	}
+
+	// Publish a span of events with a single snapshot load. Each subscriber
+	// gets every event before the next subscriber runs; batch subscribers
+	// get the span itself. Async Events queue the events one by one.
+	//
+	void publish_batch(Batch events) const {
+		if (events.empty()) return;
+		if (dispatcher_) {
+			for (const auto& e : events) {
+				dispatcher_->post(tally_->pool->make(e));
 			}
+			return;
 		}
+		dispatch_batch(events);
+	}
 
-		if (removed) {
-			slots_.store(std::move(next), std::memory_order_release);
+	// Publish taking ownership of the arguments. Synchronous subscribers see
+	// them in place; when anything queues the event they are moved into its
+	// envelope instead of being copied.
+	//
+	void publish(Ts&&... args) const requires (sizeof...(Ts) > 0) {
+		if (!dispatcher_ && tally_->mailboxes.load(std::memory_order_acquire) == 0) {
+			Envelope env;
+			dispatch(env, args...);
+			return;
+		}
+		auto env = tally_->pool->make(std::move(args)...);
+		if (dispatcher_) {
+			dispatcher_->post(std::move(env));
+			return;
 		}
+		std::apply([&](const Ts&... a) { dispatch(env, a...); }, *env);
+	}
 
-		return removed;
+	// Async Events: wait until everything published so far was delivered
+	// or dropped. No-op for synchronous Events.
+	//
+	void flush() const {
+		if (dispatcher_) dispatcher_->flush();
 	}
 
-	// Publish an event to all current subscribers.
+	bool is_async() const noexcept { return dispatcher_ != nullptr; }
+
+	// Events discarded by the backpressure policy.
 	//
-	void publish(const Ts&... args) const {
-		auto snapshot = slots_.load(std::memory_order_acquire);
-		for (auto& slot : *snapshot) {
-			try {
-				slot.second(args...);
-			} catch (...) {
-				// TODO: Swallow or route to handler.
+	std::uint64_t dropped_count() const noexcept {
+		return dispatcher_ ? dispatcher_->dropped() : 0;
+	}
+
+	// Route exceptions thrown by subscribers (mailbox ones included) to
+	// handler, with the ID of the failing subscription. Pass nullptr to go
+	// back to swallowing them. Callbacks declared noexcept never get here.
+	//
+	void set_error_handler(ErrorHandler handler) { tally_->errors->set(std::move(handler)); }
+
+	// Subscriber calls that ended in an exception, routed or not.
+	//
+	std::uint64_t failure_count() const noexcept { return tally_->errors->failures(); }
+
+	// Counters and per-subscriber latency, key-filtered subscribers included.
+	// Only failures are tracked unless built with STEL_EVENT_STATS.
+	//
+	EventStats stats() const {
+		EventStats s;
+		s.failures = tally_->errors->failures();
+		tally_->meter.fill(s);
+		std::lock_guard<std::mutex> flk(filter_mtx_);
+		{
+			std::lock_guard<std::mutex> lk(write_mtx_);
+			for (const auto& [id, slot] : index_) {
+				if (!slot->live.load(std::memory_order_relaxed)) continue;	// Released by its token
+				const LatencySummary latency = slot->meter.summary();
+				const bool router = std::any_of(routers_.begin(), routers_.end(), [&](const RouterEntry& r) {
+					return r.id == id;
+				});
+				if (router) {
+					// Its calls are the children's deliveries, counted below.
+					s.deliveries -= latency.count;
+				} else {
+					s.subscribers.push_back(SubscriberStats{id, latency});
+				}
 			}
 		}
+		for (const auto& r : routers_) {
+			r.merge(r.router.get(), s);
+		}
+		std::sort(s.subscribers.begin(), s.subscribers.end(), [](const auto& a, const auto& b) {
+			return a.id < b.id;
+		});
+		return s;
 	}
 
-	std::size_t subscriber_count() const noexcept {
-		auto snapshot = slots_.load(std::memory_order_acquire);
-		return snapshot->size();
+	// Takes the key index lock once a key-filtered subscriber exists.
+	//
+	std::size_t subscriber_count() const {
+		if (routed_.load(std::memory_order_acquire) == 0) return tally_->live.load(std::memory_order_relaxed);
+		// Key indexes occupy one slot each; count their subscribers instead.
+		// Their slots only come and go under filter_mtx_, so read live with
+		// it held.
+		std::lock_guard<std::mutex> lk(filter_mtx_);
+		const std::size_t n = tally_->live.load(std::memory_order_relaxed);
+		std::size_t total = n - std::min(n, routers_.size());
+		for (const auto& r : routers_) {
+			total += r.count(r.router.get());
+		}
+		return total;
 	}
 	
 	void clear() {
+		std::lock_guard<std::mutex> flk(filter_mtx_);
+		routers_.clear();
+		routed_.store(0, std::memory_order_relaxed);
 		std::lock_guard<std::mutex> lk(write_mtx_);
-		auto empty = std::make_shared<SlotVec>();
-		slots_.store(std::move(empty), std::memory_order_release);
+		// Tokens may keep slots alive past the snapshot: make them inert,
+		// racing them slot by slot so each live slot is counted out once.
+		for (Slot* slot : *slots_.load(std::memory_order_relaxed)) {
+			if (slot->live.exchange(false, std::memory_order_acq_rel)) tally_->release(*slot);
+		}
+		tally_->tombstones.store(0, std::memory_order_relaxed);
+		index_.clear();
+		dead_ = 0;
+		replace(snapshots_->acquire(), &destroy_all);
 	}
 
 private:
-	using Slot =		std::pair<std::size_t, Callback>;
-	using SlotVec =		std::vector<Slot>;
+	using Pool			= EnvelopePool<Ts...>;
+	using Envelope		= EnvelopePtr<Ts...>;
+	using Dispatcher	= AsyncDispatcher<Envelope>;
+
+	// Run every live subscriber on the calling thread. Mailbox subscribers
+	// get env, which is created from args on first use if still null.
+	//
+	// A subscriber may drop the last reference to us, so once the snapshot
+	// is loaded nothing is reached through this: the dispatch helpers are
+	// static and go through tally, which every slot keeps alive.
+	//
+	void dispatch(Envelope& env, const Ts&... args) const {
+		EpochGuard guard;
+		Tally& tally = *tally_;
+		auto* snapshot = slots_.load(std::memory_order_acquire);
+		if (tally.fanout && snapshot->size() > tally.fanout->chunk()) [[unlikely]] {
+			fan_out(tally, *snapshot, env, args...);
+			return;
+		}
+		const auto shared = [&]() -> const Envelope& {
+			if (!env) env = tally.pool->make(args...);
+			return env;
+		};
+		std::uint64_t delivered = 0;
+		for (const Slot* slot : *snapshot) {
+			if (!slot->live.load(std::memory_order_relaxed)) continue;
+			++delivered;
+			deliver(*slot, shared, args...);
+		}
+		tally.meter.published(1);
+		tally.meter.delivered(delivered);
+	}
+
+	// One live slot. shared() makes (once) the envelope queued deliveries
+	// need.
+	//
+	template <typename Shared>
+	static void deliver(const Slot& slot, Shared&& shared, const Ts&... args) {
+		if (!slot.invoke) [[unlikely]] {
+			const Envelope& env = shared();
+			if (slot.mailbox) {
+				slot.mailbox->offer(env);
+			} else {
+				guarded(slot, [&] { (*slot.batch)(Batch(&*env, 1)); });
+			}
+			return;
+		}
+		guarded(slot, [&] { slot.call(args...); });
+	}
+
+	// Parallel dispatch of a large snapshot over the fan-out pool. We keep
+	// our guard and wait for every chunk, so the snapshot and args stay
+	// valid; each chunk pins the epoch on its own thread too, for key
+	// routers. Order holds within a chunk only.
+	//
+	static void fan_out(Tally& tally, const std::vector<Slot*>& snapshot, Envelope& env, const Ts&... args) {
+		std::once_flag made;
+		const auto shared = [&]() -> const Envelope& {
+			// publish(Ts&&...) hands us its envelope, args point into it.
+			std::call_once(made, [&] { if (!env) env = tally.pool->make(args...); });
+			return env;
+		};
+		std::atomic<std::uint64_t> delivered{0};
+		tally.fanout->run(snapshot.size(), [&](std::size_t begin, std::size_t end) {
+			EpochGuard guard;
+			std::uint64_t n = 0;
+			for (std::size_t i = begin; i < end; i++) {
+				const Slot* slot = snapshot[i];
+				if (!slot->live.load(std::memory_order_relaxed)) continue;
+				++n;
+				deliver(*slot, shared, args...);
+			}
+			delivered.fetch_add(n, std::memory_order_relaxed);
+		});
+		tally.meter.published(1);
+		tally.meter.delivered(delivered.load(std::memory_order_relaxed));
+	}
+
+	// Batched dispatch, slot by slot. Mailboxes get one envelope per event,
+	// shared between them. As in dispatch(), only tally is used past the
+	// snapshot load.
+	//
+	void dispatch_batch(Batch events) const {
+		std::vector<Envelope> envs;
+		EpochGuard guard;
+		Tally& tally = *tally_;
+		auto* snapshot = slots_.load(std::memory_order_acquire);
+		std::uint64_t delivered = 0;
+		for (const Slot* slot : *snapshot) {
+			if (!slot->live.load(std::memory_order_relaxed)) continue;
+			delivered += slot->batch ? 1 : events.size();
+			if (slot->batch) {
+				guarded(*slot, [&] { (*slot->batch)(events); });
+			} else if (slot->mailbox) {
+				if (envs.empty()) {
+					envs.reserve(events.size());
+					for (const auto& e : events) envs.push_back(tally.pool->make(e));
+				}
+				for (const auto& env : envs) slot->mailbox->offer(env);
+			} else {
+				for (const auto& e : events) {
+					guarded(*slot, [&] { std::apply([&](const Ts&... a) { slot->call(a...); }, e); });
+				}
+			}
+		}
+		tally.meter.published(events.size());
+		tally.meter.delivered(delivered);
+	}
+
+	// Call a subscriber, routing exceptions unless it is noexcept.
+	//
+	template <typename F>
+	static void guarded(const Slot& slot, F&& call) {
+		typename SlotMeter::Scope timed(slot.meter);
+		if (slot.nothrow) {
+			call();
+			return;
+		}
+		try {
+			call();
+		} catch (...) {
+			slot.tally->errors->report(slot.id, std::current_exception());
+		}
+	}
+
+	using InboxType = Inbox<Ts...>;
+
+	// One per subscriber, shared by every snapshot that contains it.
+	//
+	// Hot/cold split: all publish reads for a plain subscriber is on the
+	// first cache line, in scan order: the flags, a copy of fn's invoker and
+	// fn's inline target. The rest of fn (its own invoker and manager, used
+	// to move and destroy it) opens the second line, followed by the ID,
+	// priority and queues that only writers and the cold mailbox/batch
+	// branch touch. The snapshot itself holds nothing but slot pointers, so
+	// the scan never strides over IDs.
+	//
+	// Slots are counted: one reference for the snapshots, one per token.
+	//
+	struct alignas(cache_line_size) Slot {
+		Slot(Tally* t, std::size_t i, Callback f, bool nt = false, int prio = 0)
+			: nothrow(nt), invoke(f.invoker()), fn(std::move(f)), priority(prio), id(i), tally(t) {
+			tally->ref();
+		}
+
+		~Slot() {
+			if (mailbox) mailbox->close();
+			tally->unref();
+		}
+
+		void ref() noexcept { refs.fetch_add(1, std::memory_order_relaxed); }
+
+		static void unref(Slot* slot) noexcept {
+			if (slot->refs.fetch_sub(1, std::memory_order_acq_rel) == 1) {
+				delete slot;
+			}
+		}
+
+		// fn(args...), through the copy of its invoker.
+		//
+		void call(const Ts&... args) const { invoke(fn.target(), args...); }
+
+		std::atomic<bool>				live{true}; // Cleared on unsubscribe, never set again
+		const bool						nothrow;	// fn cannot throw, skip the try block
+		const typename Callback::Invoker	invoke;		// fn's, null for mailbox and batch subscribers
+		Callback						fn;
+		const int						priority;	// Higher runs first
+		std::atomic<std::uint32_t>		refs{1};
+		const std::size_t				id;
+		Tally* const					tally;	// Of the owning Event, outlives it
+		std::shared_ptr<InboxType>		mailbox;	// Set for mailbox subscribers, fn is empty then
+		std::unique_ptr<BatchCallback>	batch;		// Set for batch subscribers, fn is empty then
+		[[no_unique_address]] mutable SlotMeter	meter;	// Timed by guarded(); empty without STEL_EVENT_STATS
+	};
+
+	// fn's target is its first member.
+	static_assert(offsetof(Slot, live) < cache_line_size && offsetof(Slot, invoke) < cache_line_size
+			&& offsetof(Slot, fn) + Callback::capacity <= cache_line_size,
+			"publish must find a plain subscriber on the first cache line of its slot");
+
+	template <typename F>
+	std::unique_ptr<Slot> make_slot(F&& cb, int priority) {
+		constexpr bool nothrow = std::is_nothrow_invocable_v<std::decay_t<F>&, const Ts&...>;
+		const std::size_t id = next_id_.fetch_add(1, std::memory_order_relaxed);
+		return std::make_unique<Slot>(tally_, id, Callback(std::forward<F>(cb)), nothrow, priority);
+	}
+
+	// Subscriber counts, shared by an Event and its slots so that tokens can
+	// release a slot without reaching the Event, which may be gone. Whoever
+	// wins a slot's live exchange (token, unsubscribe by ID or clear())
+	// counts it out, exactly once.
+	//
+	// For the same reason it also holds what a running publish needs after
+	// its subscribers were called: one of them may have destroyed the Event.
+	//
+	struct Tally {
+		static constexpr std::size_t kMinCompact = 64;
+
+		void ref() noexcept { refs.fetch_add(1, std::memory_order_relaxed); }
+
+		void unref() noexcept {
+			if (refs.fetch_sub(1, std::memory_order_acq_rel) == 1) {
+				delete this;
+			}
+		}
+
+		// Count out a slot whose live flag the caller just cleared.
+		//
+		void release(const Slot& slot) noexcept {
+			if (slot.mailbox) {
+				slot.mailbox->close();
+				mailboxes.fetch_sub(1, std::memory_order_relaxed);
+			}
+			live.fetch_sub(1, std::memory_order_relaxed);
+		}
+
+		std::atomic<std::size_t>						live{0};
+		std::atomic<std::size_t>						mailboxes{0};	// Live mailbox subscribers, a hint for publish
+		alignas(cache_line_size) std::atomic<std::size_t>	refs{1};
+		std::atomic<std::size_t>						tombstones{0};	// Made by tokens, not yet in dead_
+		std::atomic<std::size_t>						compact_at{kMinCompact};	// tombstones that make a token compact
+		std::atomic<bool>								closed{false};	// The Event is being destroyed
+		std::weak_ptr<Event>							owner;			// Written once, by the first apply()
+
+		// Publish state, set before the first slot that needs it is published.
+		std::shared_ptr<ErrorSink>						errors = std::make_shared<ErrorSink>();	// Shared with mailboxes
+		typename Pool::Owner							pool;			// Created on first queued delivery
+		std::shared_ptr<FanoutPool>						fanout;			// Null: publish walks the snapshot alone
+		[[no_unique_address]] EventMeter				meter;			// Written by publishers, one cache line per shard
+	};
+
+	// Per-key child Events of one projection, probed by a slot of ours.
+	//
+	template <typename Proj>
+	struct KeyRouter {
+		static_assert(std::is_empty_v<Proj> || std::equality_comparable<Proj>,
+				"a key projection must be stateless or comparable with ==, see KeyProjection");
+
+		using Key = index_key_t<std::invoke_result_t<const Proj&, const Ts&...>>;
+
+		static constexpr std::size_t kMinSweep = 64;
+
+		static constexpr char tag = 0;	// Address identifies the projection type
+
+		explicit KeyRouter(const Proj& p) : proj(p) { }
+
+		// Whether filters projecting with p belong here. Stateless types are
+		// one projection each; otherwise the value decides, so two function
+		// pointers of the same signature get an index each.
+		//
+		bool indexes(const Proj& p) const {
+			if constexpr (std::is_empty_v<Proj>) {
+				return true;
+			} else {
+				return proj == p;
+			}
+		}
+
+		// The child for key, created on first use. Children nobody subscribes
+		// to any more are dropped in batches, once their number doubled since
+		// the last sweep, so the index follows the keys in use rather than
+		// every key ever seen. Requires filter_mtx_.
+		//
+		const std::shared_ptr<Event>& child(const Key& key, const std::shared_ptr<ErrorSink>& errors) {
+			if (children.size() >= sweep_at) sweep();
+			return children.find_or_emplace(key, [&] {
+				auto child = std::make_shared<Event>();
+				child->tally_->errors = errors;
+				return child;
+			});
+		}
+
+		// Children are only subscribed to by child() callers, under
+		// filter_mtx_, so an empty one stays empty. Publishers still inside a
+		// dropped child are covered by the epoch: the map retires its nodes.
+		//
+		void sweep() {
+			children.erase_if([&](const auto&, std::shared_ptr<Event>& ev) {
+				if (ev->subscriber_count() != 0) return false;
+				if constexpr (event_stats_enabled) {
+					const EventStats gone = ev->stats();
+					retired.deliveries += gone.deliveries;
+					retired.rebuilds += gone.rebuilds;
+				}
+				return true;
+			});
+			sweep_at = std::max(kMinSweep, children.size() * 2);
+		}
+
+		// Runs inside dispatch(), which holds the EpochGuard find() needs.
+		//
+		void operator ()(const Ts&... args) const {
+			if (auto* child = children.find(std::invoke(proj, args...))) {
+				(*child)->publish(args...);
+			}
+		}
+
+		static std::size_t count(void* p) {
+			std::size_t n = 0;
+			static_cast<KeyRouter*>(p)->children.for_each([&](const auto&, std::shared_ptr<Event>& ev) {
+				n += ev->subscriber_count();
+			});
+			return n;
+		}
+
+		// Children share our ErrorSink and see only events we published, so
+		// only their deliveries, rebuilds and subscribers are added.
+		//
+		static void merge(void* p, EventStats& s) {
+			auto* router = static_cast<KeyRouter*>(p);
+			s.deliveries += router->retired.deliveries;
+			s.rebuilds += router->retired.rebuilds;
+			router->children.for_each([&](const auto&, std::shared_ptr<Event>& ev) {
+				EventStats child = ev->stats();
+				s.deliveries += child.deliveries;
+				s.rebuilds += child.rebuilds;
+				s.subscribers.insert(s.subscribers.end(), child.subscribers.begin(), child.subscribers.end());
+			});
+		}
+
+		const Proj								proj;
+		TopicMap<std::shared_ptr<Event>, Key>	children;	// Writers hold filter_mtx_
+		std::size_t								sweep_at = kMinSweep;	// Requires filter_mtx_
+		EventStats								retired;	// Counters of dropped children, requires filter_mtx_
+	};
+
+	struct RouterEntry {
+		const void*				tag;
+		std::size_t				id;		// Of the slot probing the router
+		std::shared_ptr<void>	router;
+		std::size_t				(*count)(void*);
+		void					(*merge)(void*, EventStats&);
+	};
+
+	// The child Event for filter's key, creating the index on first use.
+	// Requires filter_mtx_, which the caller holds until it subscribed to
+	// the child.
+	//
+	template <typename Proj, typename V>
+	const std::shared_ptr<Event>& route(const KeyFilter<Proj, V>& filter) {
+		using Router = KeyRouter<Proj>;
+		Router* router = nullptr;
+		for (const auto& r : routers_) {
+			if (r.tag == &Router::tag && static_cast<Router*>(r.router.get())->indexes(filter.proj)) {
+				router = static_cast<Router*>(r.router.get());
+				break;
+			}
+		}
+		if (!router) {
+			auto owned = std::make_shared<Router>(filter.proj);
+			router = owned.get();
+			const std::size_t id = next_id_.fetch_add(1, std::memory_order_relaxed);
+			std::unique_ptr<Slot> adds[1] = {std::make_unique<Slot>(tally_, id, [owned](const Ts&... args) {
+				(*owned)(args...);
+			})};
+			routers_.push_back(RouterEntry{&Router::tag, id, owned, &Router::count, &Router::merge});
+			apply(adds, {});
+			routed_.fetch_add(1, std::memory_order_release);
+		}
+		return router->child(typename Router::Key(filter.key), tally_->errors);
+	}
+
+	// Add a slot delivering through the inbox returned by make(id).
+	//
+	template <typename Make>
+	Subscription add_inbox(Make&& make) {
+		const std::size_t id = next_id_.fetch_add(1, std::memory_order_relaxed);
+		auto slot = std::make_unique<Slot>(tally_, id, nullptr);
+		slot->mailbox = make(id);
+		{
+			// The pool must exist before the first mailbox slot is published.
+			std::lock_guard<std::mutex> lk(write_mtx_);
+			if (!tally_->pool) tally_->pool = Pool::create();
+		}
+		tally_->mailboxes.fetch_add(1, std::memory_order_release);
+		return add(std::move(slot));
+	}
+
+	Subscription add(std::unique_ptr<Slot> slot) {
+		Slot* raw = slot.get();
+		raw->ref();
+		std::unique_ptr<Slot> adds[1] = {std::move(slot)};
+		apply(adds, {});
+		return Subscription{raw};
+	}
+
+	struct SnapshotPool;
+
+	// A snapshot: slot pointers, plus the pool its vector returns to.
+	//
+	struct SlotVec : std::vector<Slot*> {
+		SnapshotPool* pool = nullptr;
+	};
+
+	// Recycles snapshot vectors together with their buffers, so steady-state
+	// subscribe/unsubscribe stops allocating. Retired snapshots come back
+	// through the EpochDomain, on whichever writer thread collects them and
+	// possibly after the Event is gone, hence the reference count (the Event
+	// plus every snapshot handed out) and the lock.
+	//
+	struct SnapshotPool {
+		static constexpr std::size_t kMaxCached = 4;
+
+		SnapshotPool() { free.reserve(kMaxCached); }
+
+		~SnapshotPool() {
+			for (SlotVec* vec : free) {
+				delete vec;
+			}
+		}
+
+		SlotVec* acquire() {
+			SlotVec* vec = nullptr;
+			{
+				std::lock_guard<SpinLock> lk(lock);
+				if (!free.empty()) {
+					vec = free.back();
+					free.pop_back();
+				}
+			}
+			if (!vec) {
+				vec = new SlotVec();
+				vec->pool = this;
+			}
+			refs.fetch_add(1, std::memory_order_relaxed);
+			return vec;
+		}
+
+		void recycle(SlotVec* vec) noexcept {
+			vec->clear();
+			{
+				std::lock_guard<SpinLock> lk(lock);
+				if (free.size() < kMaxCached) {
+					free.push_back(vec);	// Never reallocates, see reserve()
+					vec = nullptr;
+				}
+			}
+			delete vec;
+			unref();
+		}
+
+		void unref() noexcept {
+			if (refs.fetch_sub(1, std::memory_order_acq_rel) == 1) {
+				delete this;
+			}
+		}
+
+		std::atomic<std::size_t>	refs{1};
+		SpinLock					lock;
+		std::vector<SlotVec*>		free;	// Requires lock
+	};
+
+	struct Recycle {
+		void operator ()(SlotVec* vec) const noexcept { destroy_vec(vec); }
+	};
+
+	using SnapshotPtr = std::unique_ptr<SlotVec, Recycle>;
+
+	SnapshotPtr make_snapshot() { return SnapshotPtr(snapshots_->acquire()); }
+
+	static bool runs_before(const Slot* a, const Slot* b) noexcept { return a->priority > b->priority; }
+
+	// Deleter for a snapshot whose slots are no longer referenced anywhere.
+	//
+	static void destroy_all(void* p) {
+		auto* vec = static_cast<SlotVec*>(p);
+		for (Slot* slot : *vec) {
+			Slot::unref(slot);
+		}
+		vec->pool->recycle(vec);
+	}
+
+	static void destroy_vec(void* p) {
+		auto* vec = static_cast<SlotVec*>(p);
+		vec->pool->recycle(vec);
+	}
+
+	// Publish a new snapshot and retire the previous one. Requires write_mtx_.
+	//
+	void replace(SlotVec* next, EpochDomain::Deleter deleter = &destroy_vec) {
+		SlotVec* prev = slots_.exchange(next, std::memory_order_acq_rel);
+		EpochDomain::instance().retire(prev, deleter);
+		tally_->meter.rebuilt();
+	}
+
+	// Copy the live slots of curr into next, return the tombstoned ones.
+	//
+	std::vector<Slot*> split(const SlotVec& curr, SlotVec& next) {
+		std::vector<Slot*> dropped;
+		dropped.reserve(dead_);
+		for (Slot* slot : curr) {
+			if (slot->live.load(std::memory_order_relaxed)) {
+				next.push_back(slot);
+			} else {
+				index_.erase(slot->id);	// Still indexed if its token released it
+				dropped.push_back(slot);
+			}
+		}
+		dead_ = 0;
+		return dropped;
+	}
+
+	// Publish next; tombstoned slots dropped from it are reclaimed once no
+	// publisher can still reach them through an older snapshot.
+	//
+	void commit(SnapshotPtr next, std::vector<Slot*> dropped) {
+		replace(next.release());
+		if (!dropped.empty()) {
+			SnapshotPtr garbage = make_snapshot();
+			garbage->swap(dropped);
+			EpochDomain::instance().retire(garbage.release(), &destroy_all);
+		}
+	}
+
+	bool tombstone(std::size_t id) {
+		auto it = index_.find(id);
+		if (it == index_.end()) return false;
+		Slot* slot = it->second;
+		index_.erase(it);
+		// Publishers that already loaded the slot may still be calling it,
+		// exactly as with a snapshot taken before the unsubscribe. Losing
+		// the exchange means its token got there first, see reconcile().
+		if (!slot->live.exchange(false, std::memory_order_acq_rel)) return false;
+		tally_->release(*slot);
+		++dead_;
+		return true;
+	}
+
+	// Fold in the tombstones tokens made since the last write, and set how
+	// many more make a token compact: about as many as would let tombstones
+	// outnumber live slots. Requires write_mtx_.
+	//
+	void reconcile() {
+		dead_ += tally_->tombstones.exchange(0, std::memory_order_relaxed);
+		const std::size_t live = tally_->live.load(std::memory_order_relaxed);
+		const std::size_t margin = live > dead_ ? (live - dead_) / 2 + 1 : 1;
+		tally_->compact_at.store(std::max(Tally::kMinCompact, margin), std::memory_order_relaxed);
+	}
+
+	// Writer-side pass for released tokens; force rebuilds even when only a
+	// few tombstones are left.
+	//
+	void purge(bool force) {
+		std::lock_guard<std::mutex> lk(write_mtx_);
+		reconcile();
+		if (force && dead_ != 0) {
+			compact();
+		} else {
+			maybe_compact();
+		}
+	}
+
+	// Tombstone removes, then append adds in one copy-on-write step.
+	// The copy is made anyway, so tombstones are dropped from it for free.
+	//
+	void apply(std::span<std::unique_ptr<Slot>> adds, std::span<const std::size_t> removes) {
+		std::lock_guard<std::mutex> lk(write_mtx_);
+		if (!adds.empty() && !owner_published_) {
+			// Before any token exists, so tokens only ever read it.
+			tally_->owner = this->weak_from_this();
+			owner_published_ = true;
+		}
+		reconcile();
+		for (std::size_t id : removes) {
+			tombstone(id);
+		}
+		if (adds.empty()) {
+			maybe_compact();
+			return;
+		}
+
+		auto next = make_snapshot();
+		next->reserve(tally_->live.load(std::memory_order_relaxed) + adds.size());
+		auto dropped = split(*slots_.load(std::memory_order_relaxed), *next);
+		const std::ptrdiff_t mid = static_cast<std::ptrdiff_t>(next->size());
+		for (auto& slot : adds) {
+			index_.emplace(slot->id, slot.get());
+			next->push_back(slot.release());
+		}
+		// Priority order is paid for here rather than per publish. Both steps
+		// are stable, so equal priorities run in subscription order.
+		if (!std::is_sorted(next->begin() + mid, next->end(), &runs_before)) {
+			std::stable_sort(next->begin() + mid, next->end(), &runs_before);
+		}
+		if (mid > 0 && runs_before((*next)[mid], (*next)[mid - 1])) {
+			std::inplace_merge(next->begin(), next->begin() + mid, next->end(), &runs_before);
+		}
+		commit(std::move(next), std::move(dropped));
+		tally_->live.fetch_add(adds.size(), std::memory_order_relaxed);
+	}
 
-	// Snapshot of subscribers, atomically replaced on updates.
-	std::atomic<std::shared_ptr<SlotVec>>	slots_;
-	std::mutex								write_mtx_; // Protects copy-on-write updates
+	// Rebuild once tombstones outnumber live slots, which keeps both the
+	// publish scan and the total rebuild work linear in live subscribers.
+	//
+	void maybe_compact() {
+		if (dead_ == 0 || dead_ <= tally_->live.load(std::memory_order_relaxed)) return;
+		compact();
+	}
+
+	void compact() {
+		auto next = make_snapshot();
+		next->reserve(tally_->live.load(std::memory_order_relaxed));
+		auto dropped = split(*slots_.load(std::memory_order_relaxed), *next);
+		commit(std::move(next), std::move(dropped));
+	}
+
+	// Read by every publish, written only when the subscriber set changes.
+	// Kept on its own cache line so writer bookkeeping below does not
+	// invalidate it under publishers.
+	//
+	alignas(cache_line_size) std::atomic<SlotVec*>	slots_;	// Snapshot, atomically replaced on updates
+	Tally* const							tally_;			// Live counts and publish state, shared with slots
+	std::unique_ptr<Dispatcher>				dispatcher_;	// Null for synchronous Events
+
+	// Writer state.
+	//
+	alignas(cache_line_size) mutable std::mutex	write_mtx_; // Protects copy-on-write updates
 	std::atomic<std::size_t>				next_id_;
+	std::size_t								dead_ = 0;	// Tombstones in slots_, requires write_mtx_
+	std::unordered_map<std::size_t, Slot*>	index_;		// Live slots by ID, requires write_mtx_
+	mutable std::mutex						filter_mtx_; // Protects routers_, taken before write_mtx_
+	std::vector<RouterEntry>				routers_;
+	std::atomic<std::size_t>				routed_{0};	// routers_.size(), readable without the lock
+	bool									owner_published_ = false;	// tally_->owner set, requires write_mtx_
+	SnapshotPool*							snapshots_;	// Shared with outstanding snapshots
+};
+
+/// SubscriptionGroup<Ts...> owns subscriptions to any number of Event<Ts...>
+/// (EventBus topics and patterns included) and drops them together.
+///
+/// - clear(), also run by the destructor, releases every token without
+///   letting any of them compact, then rebuilds the snapshot of each Event
+///   involved once.
+/// - Events that are already gone are skipped.
+///
+/// Typical use:
+///   SubscriptionGroup<int> session;
+///   session += bus.subscribe("cpu", on_cpu);
+///   session += ev->subscribe(on_tick);
+///   ...
+///   session.clear();
+///
+template <typename... Ts>
+class SubscriptionGroup {
+public:
+	using Subscription = typename Event<Ts...>::Subscription;
+
+	SubscriptionGroup() = default;
+	~SubscriptionGroup() { clear(); }
+
+	SubscriptionGroup(SubscriptionGroup&&) noexcept = default;
+
+	SubscriptionGroup& operator =(SubscriptionGroup&& other) noexcept {
+		if (this != &other) {
+			clear();
+			subs_ = std::move(other.subs_);
+		}
+		return *this;
+	}
+
+	void add(Subscription&& sub) {
+		if (sub) subs_.push_back(std::move(sub));
+	}
 
+	// E.g. the result of a Transaction commit.
+	//
+	void add(std::vector<Subscription>&& subs) {
+		subs_.reserve(subs_.size() + subs.size());
+		for (auto& sub : subs) {
+			add(std::move(sub));
+		}
+		subs.clear();
+	}
+
+	SubscriptionGroup& operator +=(Subscription&& sub) {
+		add(std::move(sub));
+		return *this;
+	}
+
+	// Unsubscribe everything, returns how many subscribers were removed.
+	//
+	std::size_t clear() {
+		using Tally = typename Event<Ts...>::Tally;
+		std::vector<Tally*> tallies;
+		tallies.reserve(subs_.size());
+		for (const auto& sub : subs_) {
+			tallies.push_back(sub.slot_->tally);
+		}
+		std::sort(tallies.begin(), tallies.end());
+		tallies.erase(std::unique(tallies.begin(), tallies.end()), tallies.end());
+		// Releasing may free the last slot holding a tally.
+		for (Tally* tally : tallies) {
+			tally->ref();
+		}
+
+		std::size_t removed = 0;
+		for (auto& sub : subs_) {
+			removed += sub.release(false);
+		}
+		subs_.clear();
+
+		for (Tally* tally : tallies) {
+			if (auto ev = tally->owner.lock()) ev->purge(true);
+			tally->unref();
+		}
+		return removed;
+	}
+
+	std::size_t size() const noexcept { return subs_.size(); }
+
+	bool empty() const noexcept { return subs_.empty(); }
+
+private:
+	std::vector<Subscription> subs_;
 };
 
+/// EventBus<Ts...> routes events to per-topic Event<Ts...> channels.
+///
+/// - publish(...) is lock-free: the topic registry is a TopicMap read under an
+///   EpochGuard, so publishers on different topics never serialize.
+/// - Only topic creation takes the write path (small mutex).
+/// - topic(name) resolves a name once and returns a Topic handle bound to the
+///   channel, so hot publishers skip hashing and lookup entirely.
+/// - Topics are '.'-separated. Subscribing to a pattern ("cpu.*.temp",
+///   "cpu.#") subscribes to every topic it matches, see TopicTrie. Each
+///   channel caches the pattern Events matching it; the cache is extended
+///   when a new pattern appears, so publish never walks the trie. The first
+///   publish to a topic that only patterns match creates its channel (and
+///   never sweeps, that is left to writers). Topics no pattern matches are
+///   remembered until the next pattern is added, so publishing to them
+///   stays lock-free as well.
+/// - stats() reports Event::stats() per topic and per pattern.
+/// - Channels nobody uses any more (no subscribers, no Topic handle, no
+///   outside reference to their Event) are reclaimed in batches: creating
+///   channels triggers a sweep once their number doubles since the last
+///   one, and a channel is only dropped when two sweeps in a row found it
+///   idle with no writer touching it in between, so flapping topics are
+///   not recreated over and over. collect_idle() sweeps on demand.
+/// - journal(topic) keeps a topic's recent history (in memory or in an
+///   mmap-backed segment file); subscribe_from(topic, offset, cb) replays it
+///   and then follows live events.
+///
+/// Typical use:
+///   EventBus<int> bus;
+///   auto cpu = bus.topic("cpu");
+///   auto sub = cpu.subscribe([](int v) { ... });
+///   auto any = bus.subscribe("cpu.#", [](int v) { ... });
+///   cpu.publish(42);
+///
 template <typename... Ts>
 class EventBus {
 public:
 	using EventType = Event<Ts...>;
 
-	typename EventType::Subscription subscribe(const std::string& topic,
-			typename EventType::Callback cb) {
+private:
+	using Patterns	= TopicTrie<std::shared_ptr<EventType>>;
+	using Matches	= std::vector<std::shared_ptr<EventType>>;
+
+	// A literal topic: its own Event plus the pattern Events that match it.
+	//
+	struct Channel {
+		explicit Channel(Matches m)
+			: event(std::make_shared<EventType>())
+			, matches(m.empty() ? nullptr : new Matches(std::move(m))) { }
+
+		~Channel() {
+			if (Matches* m = matches.load(std::memory_order_relaxed)) {
+				EpochDomain::instance().retire(m);
+			}
+		}
+
+		void publish(const Ts&... args) const {
+			EpochGuard guard;
+			event->publish(args...);
+			if (const Matches* m = matches.load(std::memory_order_acquire)) {
+				for (const auto& ev : *m) {
+					ev->publish(args...);
+				}
+			}
+		}
+
+		// Copy-on-write append. Requires the bus writer mutex.
+		//
+		void add_match(const std::shared_ptr<EventType>& ev) {
+			const Matches* curr = matches.load(std::memory_order_relaxed);
+			auto next = std::make_unique<Matches>(curr ? *curr : Matches{});
+			next->push_back(ev);
+			if (Matches* prev = matches.exchange(next.release(), std::memory_order_acq_rel)) {
+				EpochDomain::instance().retire(prev);
+			}
+		}
+
+		const std::shared_ptr<EventType>	event;
+		std::atomic<Matches*>				matches;	// Null until a pattern matches
+		bool								idle = false;	// Seen unused by the last sweep, requires m_
+	};
+
+	// A journaled topic, see journal().
+	//
+	struct Journaled {
+		std::shared_ptr<Journal<Ts...>>		journal;
+		typename EventType::Subscription	sub;	// The journal's slot in its channel
+	};
+
+public:
+	// Pre-resolved channel. Cheap to copy, keeps the channel alive.
+	//
+	class Topic {
+	public:
+		Topic() = default;
+
+		void publish(const Ts&... args) const { ch_->publish(args...); }
+
+		// Same arguments as Event::subscribe.
+		//
+		template <typename... Args>
+		[[nodiscard]] typename EventType::Subscription subscribe(Args&&... args) const {
+			return ch_->event->subscribe(std::forward<Args>(args)...);
+		}
+
+		std::size_t subscriber_count() const { return ch_->event->subscriber_count(); }
+
+		const std::shared_ptr<EventType>& event() const noexcept { return ch_->event; }
+
+		explicit operator bool() const noexcept { return static_cast<bool>(ch_); }
+
+	private:
+		friend class EventBus;
+		explicit Topic(std::shared_ptr<Channel> ch) : ch_(std::move(ch)) { }
+		std::shared_ptr<Channel> ch_;
+	}; // class Topic
+
+	// Stages subscribes and unsubscribes across topics. commit() resolves
+	// all topics under one lock and rebuilds each channel's snapshot once.
+	//
+	class Transaction {
+	public:
+		Transaction(Transaction&&) noexcept				= default;
+		Transaction& operator =(Transaction&&) noexcept	= default;
+
+		// Stage a subscriber. Returns its position in the vector returned
+		// by commit().
+		//
+		std::size_t subscribe(std::string_view topic, typename EventType::Callback cb, int priority = 0) {
+			adds_.push_back(Add{std::string(topic), std::move(cb), priority});
+			return adds_.size() - 1;
+		}
+
+		void unsubscribe(std::string_view topic, typename EventType::Subscription&& sub) {
+			removes_.emplace_back(std::string(topic), std::move(sub));
+		}
+
+		[[nodiscard]] std::vector<typename EventType::Subscription> commit() {
+			std::vector<typename EventType::Transaction> groups;
+			std::unordered_map<EventType*, std::size_t> group_of;
+			std::vector<std::pair<std::size_t, std::size_t>> where; // (group, position)
+			where.reserve(adds_.size());
+
+			auto group = [&](const std::shared_ptr<EventType>& ch) {
+				auto [it, inserted] = group_of.try_emplace(ch.get(), groups.size());
+				if (inserted) {
+					groups.push_back(ch->transaction());
+				}
+				return it->second;
+			};
+
+			{
+				std::lock_guard<std::mutex> lk(bus_->m_);
+				for (auto& [topic, cb, priority] : adds_) {
+					const std::size_t g = group(bus_->target(topic));
+					where.emplace_back(g, groups[g].subscribe(std::move(cb), priority));
+				}
+				EpochGuard guard;
+				for (auto& [topic, sub] : removes_) {
+					if (auto* ev = bus_->find_target(topic)) {
+						groups[group(*ev)].unsubscribe(std::move(sub));
+					} else {
+						sub.unsubscribe();
+					}
+				}
+			}
+
+			std::vector<std::vector<typename EventType::Subscription>> committed;
+			committed.reserve(groups.size());
+			for (auto& tx : groups) {
+				committed.push_back(tx.commit());
+			}
+
+			std::vector<typename EventType::Subscription> subs;
+			subs.reserve(where.size());
+			for (auto [g, pos] : where) {
+				subs.push_back(std::move(committed[g][pos]));
+			}
+			adds_.clear();
+			removes_.clear();
+			return subs;
+		}
+
+		bool empty() const noexcept { return adds_.empty() && removes_.empty(); }
+
+	private:
+		friend class EventBus;
+		explicit Transaction(EventBus& bus) : bus_(&bus) { }
+
+		struct Add {
+			std::string						topic;
+			typename EventType::Callback	cb;
+			int								priority;
+		};
+
+		EventBus*															bus_;
+		std::vector<Add>													adds_;
+		std::vector<std::pair<std::string, typename EventType::Subscription>>	removes_;
+	}; // class Transaction
+
+	[[nodiscard]] Transaction transaction() { return Transaction{*this}; }
+
+	// Resolve (creating if needed) the channel for a literal topic.
+	// Throws std::invalid_argument for patterns, which have no channel.
+	//
+	[[nodiscard]] Topic topic(std::string_view name) {
+		if (Patterns::is_pattern(name)) {
+			throw std::invalid_argument("EventBus::topic() needs a literal topic");
+		}
+		std::lock_guard<std::mutex> lk(m_);
+		return Topic{channel(name)};
+	}
+
+	// Subscribe to a literal topic or to every topic matching a pattern.
+	// args are those of Event::subscribe (callback, then priority or
+	// MailboxOptions).
+	//
+	template <typename... Args>
+	typename EventType::Subscription subscribe(std::string_view topic, Args&&... args) {
+		std::lock_guard<std::mutex> lk(m_);
+		return target(topic)->subscribe(std::forward<Args>(args)...);
+	}
+
+	// Conflating subscription to a topic or pattern, see Event::subscribe_latest.
+	//
+	template <typename... Args>
+	typename EventType::Subscription subscribe_latest(std::string_view topic, Args&&... args) {
+		std::lock_guard<std::mutex> lk(m_);
+		return target(topic)->subscribe_latest(std::forward<Args>(args)...);
+	}
+
+	// Journal a literal topic from now on, see Journal. A topic has at most
+	// one journal: later calls return it and ignore opts. Throws like the
+	// Journal constructor.
+	//
+	std::shared_ptr<Journal<Ts...>> journal(std::string_view topic, const JournalOptions& opts = {}) {
+		if (Patterns::is_pattern(topic)) throw std::invalid_argument("EventBus::journal: patterns cannot be journaled");
 		std::lock_guard<std::mutex> lk(m_);
-		auto& ch = channels_[topic];
-		if (!ch) {
-			ch = std::make_shared<EventType>();
+		auto it = journals_.find(topic);
+		if (it != journals_.end()) return it->second.journal;
+		auto journal = std::make_shared<Journal<Ts...>>(opts);
+		auto sub = channel(topic)->event->subscribe(journal);
+		journals_.emplace(std::string(topic), Journaled{journal, std::move(sub)});
+		return journal;
+	}
+
+	// Replay a journaled topic from offset (see Journal::first()/end()), then
+	// deliver its live events, without gap or duplicate. cb runs on the
+	// journal's executor. Throws std::invalid_argument if topic has no
+	// journal.
+	//
+	[[nodiscard]] typename Journal<Ts...>::Cursor subscribe_from(std::string_view topic, std::uint64_t offset,
+			typename Journal<Ts...>::Callback cb) {
+		std::shared_ptr<Journal<Ts...>> journal;
+		{
+			std::lock_guard<std::mutex> lk(m_);
+			auto it = journals_.find(topic);
+			if (it == journals_.end()) throw std::invalid_argument("EventBus::subscribe_from: topic is not journaled");
+			journal = it->second.journal;
 		}
-		return ch->subscribe(std::move(cb));
+		return journal->follow(offset, std::move(cb));
 	}
 
-	void publish(const std::string& topic, const Ts& ...args) const {
-		std::shared_ptr<EventType> ch;
+	void publish(std::string_view topic, const Ts& ...args) const {
+		// Held throughout, which also keeps reclamation off this thread when
+		// creating a channel below.
+		EpochGuard guard;
+		if (auto* ch = channels_.find(topic)) {
+			(*ch)->publish(args...);
+			return;
+		}
+		if (patterns_count_.load(std::memory_order_acquire) == 0 || misses_.find(topic)) return;
+		// Resolve a topic only patterns know about, once. Topics no pattern
+		// matches get no channel, only an entry in misses_; the sweep is
+		// left to writers.
+		std::shared_ptr<Channel> ch;
 		{
 			std::lock_guard<std::mutex> lk(m_);
-			auto it = channels_.find(topic);
-			if (it != channels_.end()) {
-				ch = it->second;
+			if (auto* existing = channels_.find(topic)) {
+				ch = *existing;
+			} else {
+				bool matched = false;
+				patterns_.match(topic, [&](std::shared_ptr<EventType>&) { matched = true; });
+				if (!matched) {
+					miss(topic);
+					return;
+				}
+				ch = channel(topic, false);
 			}
 		}
-		if (ch) {
-			ch->publish(args...);
+		ch->publish(args...);
+	}
+
+	std::size_t subsriber_count(std::string_view topic) const {
+		if (Patterns::is_pattern(topic)) {
+			std::lock_guard<std::mutex> lk(m_);
+			auto* ev = patterns_.find(topic);
+			return ev ? (*ev)->subscriber_count() : 0;
 		}
+		EpochGuard guard;
+		auto* ch = channels_.find(topic);
+		return ch ? (*ch)->event->subscriber_count() : 0;
 	}
 
-	std::size_t subsriber_count(const std::string& topic) const {
+	// Sweep for unused channels now: those already found idle by the previous
+	// sweep are reclaimed, the others are marked. Returns how many channels
+	// were reclaimed.
+	//
+	std::size_t collect_idle() {
 		std::lock_guard<std::mutex> lk(m_);
-		auto it = channels_.find(topic);
-		return it == channels_.end() ? 0 : it->second->subscriber_count();
+		return sweep();
+	}
+
+	std::size_t channel_count() const noexcept {
+		std::lock_guard<std::mutex> lk(m_);
+		return channels_.size();
+	}
+
+	// Event::stats() of every channel and every pattern, sorted by topic.
+	// Subscribers of a pattern are reported under the pattern, not under
+	// each topic it matched.
+	//
+	std::vector<TopicStats> stats() const {
+		std::vector<std::pair<std::string, std::shared_ptr<EventType>>> events;
+		{
+			std::lock_guard<std::mutex> lk(m_);
+			channels_.for_each([&](std::string_view name, std::shared_ptr<Channel>& ch) {
+				events.emplace_back(std::string(name), ch->event);
+			});
+			patterns_.for_each([&](std::string_view name, std::shared_ptr<EventType>& ev) {
+				events.emplace_back(std::string(name), ev);
+			});
+		}
+		std::vector<TopicStats> out;
+		out.reserve(events.size());
+		for (auto& [name, ev] : events) {
+			out.push_back(TopicStats{std::move(name), ev->stats()});
+		}
+		std::sort(out.begin(), out.end(), [](const auto& a, const auto& b) { return a.topic < b.topic; });
+		return out;
 	}
 
 private:
-	mutable std::mutex m_;
-	std::unordered_map<std::string, std::shared_ptr<EventType>> channels_;
+	static constexpr std::size_t kMinSweep = 64;
+	static constexpr std::size_t kMaxMisses = 4096;
+
+	// Requires m_. A new channel starts out with every pattern matching it.
+	// The returned reference is valid until the next write to channels_.
+	// Publishers pass may_sweep = false, so they never free channels.
+	//
+	std::shared_ptr<Channel>& channel(std::string_view topic, bool may_sweep = true) const {
+		if (may_sweep && channels_.size() >= sweep_at_) {
+			sweep();
+		}
+		auto& ch = channels_.find_or_emplace(topic, [&] {
+			Matches matches;
+			patterns_.match(topic, [&](std::shared_ptr<EventType>& ev) { matches.push_back(ev); });
+			return std::make_shared<Channel>(std::move(matches));
+		});
+		ch->idle = false;
+		return ch;
+	}
+
+	// Requires m_. Every shared_ptr taken to a channel or to its Event is
+	// taken under m_ or from one that already exists, so use counts seen
+	// here cannot rise behind our back. Publishers still in a reclaimed
+	// channel are covered by the epoch: the map retires its nodes.
+	//
+	std::size_t sweep() const {
+		const std::size_t reclaimed = channels_.erase_if([](std::string_view, std::shared_ptr<Channel>& ch) {
+			const bool unused = ch.use_count() == 1 && ch->event.use_count() == 1
+					&& ch->event->subscriber_count() == 0;
+			const bool reclaim = unused && ch->idle;
+			ch->idle = unused;
+			return reclaim;
+		});
+		sweep_at_ = std::max(kMinSweep, channels_.size() * 2);
+		return reclaimed;
+	}
+
+	// Requires m_. Remember that no pattern matches topic. The cache is
+	// simply emptied when full: misses are cheap to find again, and erasing
+	// only retires nodes, so publishers still free nothing.
+	//
+	void miss(std::string_view topic) const {
+		if (misses_.size() >= kMaxMisses) {
+			misses_.erase_if([](std::string_view, std::monostate) { return true; });
+		}
+		misses_.find_or_emplace(topic, [] { return std::monostate{}; });
+	}
+
+	// Requires m_. A new pattern is added to every existing channel it
+	// matches, and may match topics cached as misses.
+	//
+	std::shared_ptr<EventType>& pattern(std::string_view topic) {
+		bool created = false;
+		auto& ev = patterns_.find_or_emplace(topic, [&] {
+			created = true;
+			return std::make_shared<EventType>();
+		});
+		if (created) {
+			channels_.for_each([&](std::string_view name, std::shared_ptr<Channel>& ch) {
+				if (Patterns::matches(topic, name)) ch->add_match(ev);
+			});
+			if (misses_.size() != 0) {
+				misses_.erase_if([](std::string_view, std::monostate) { return true; });
+			}
+			patterns_count_.fetch_add(1, std::memory_order_release);
+		}
+		return ev;
+	}
+
+	// Requires m_. The Event subscribers of topic (literal or pattern) live in.
+	//
+	const std::shared_ptr<EventType>& target(std::string_view topic) {
+		return Patterns::is_pattern(topic) ? pattern(topic) : channel(topic)->event;
+	}
+
+	// Requires m_ and an EpochGuard. Like target() but never creates.
+	//
+	const std::shared_ptr<EventType>* find_target(std::string_view topic) const {
+		if (Patterns::is_pattern(topic)) return patterns_.find(topic);
+		auto* ch = channels_.find(topic);
+		return ch ? &(*ch)->event : nullptr;
+	}
+
+	// publish() may create channels for topics first reached through a
+	// pattern, hence mutable. What publishers read comes first, the writer
+	// mutex and the trie live on their own cache line.
+	mutable TopicMap<std::shared_ptr<Channel>>	channels_;
+	mutable TopicMap<std::monostate>			misses_;	// Topics no pattern matches, written under m_
+	std::atomic<std::size_t>					patterns_count_{0};
+	alignas(cache_line_size) mutable std::mutex	m_;	// Serializes writers of channels_ and patterns_
+	mutable Patterns							patterns_;
+	mutable std::size_t							sweep_at_ = kMinSweep;	// Channel count triggering a sweep, requires m_
+	std::map<std::string, Journaled, std::less<>>	journals_;	// Requires m_, destroyed before the channels
 };
 
 } // namespace stel
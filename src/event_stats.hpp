@@ -0,0 +1,239 @@
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <bit>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include "config.hpp"
+
+namespace stel {
+
+// Callback latency of one subscriber, in nanoseconds. Quantiles are the upper
+// bound of their histogram bucket, within 1/8 of the true value.
+//
+struct LatencySummary {
+	std::uint64_t	count	= 0;
+	std::uint64_t	p50		= 0;
+	std::uint64_t	p90		= 0;
+	std::uint64_t	p99		= 0;
+	std::uint64_t	max		= 0;
+};
+
+struct SubscriberStats {
+	std::size_t		id;			// Subscription::id()
+	LatencySummary	latency;	// Empty for mailbox subscribers, which run elsewhere
+};
+
+// Point-in-time view of one Event, see Event::stats(). Counters other than
+// failures stay zero unless built with STEL_EVENT_STATS.
+//
+struct EventStats {
+	std::uint64_t					publishes	= 0;	// Events dispatched, batches count each event
+	std::uint64_t					deliveries	= 0;	// Callback calls plus mailbox offers
+	std::uint64_t					failures	= 0;	// Exceptions caught around callbacks
+	std::uint64_t					rebuilds	= 0;	// Snapshots published by writers
+	std::vector<SubscriberStats>	subscribers;
+};
+
+struct TopicStats {
+	std::string	topic;	// Literal topic or pattern
+	EventStats	stats;
+};
+
+/// ShardedCounter is a relaxed counter for many concurrent writers.
+///
+/// - Each thread adds to one of kShards cache-line sized cells (threads are
+///   assigned cells round-robin on first use), so writers on different
+///   threads rarely share a line. load() sums the cells.
+///
+/// Typical use:
+///   ShardedCounter hits;
+///   hits.add();
+///   std::uint64_t n = hits.load();
+///
+class ShardedCounter {
+public:
+	static constexpr std::size_t kShards = 16;
+
+	void add(std::uint64_t n = 1) noexcept {
+		cells_[shard()].value.fetch_add(n, std::memory_order_relaxed);
+	}
+
+	std::uint64_t load() const noexcept {
+		std::uint64_t total = 0;
+		for (const auto& cell : cells_) {
+			total += cell.value.load(std::memory_order_relaxed);
+		}
+		return total;
+	}
+
+private:
+	struct alignas(cache_line_size) Cell {
+		std::atomic<std::uint64_t> value{0};
+	};
+
+	static std::size_t shard() noexcept {
+		static std::atomic<std::size_t> next{0};
+		thread_local const std::size_t mine = next.fetch_add(1, std::memory_order_relaxed) % kShards;
+		return mine;
+	}
+
+	std::array<Cell, kShards> cells_;
+};
+
+/// LatencyHistogram records durations in log-linear buckets (HDR-style).
+///
+/// - Each power of two is split into kSubBuckets linear buckets, so any
+///   recorded value is off by at most 1/kSubBuckets of itself. Values past
+///   2^kMaxBits ns (about 18 minutes) land in the last bucket.
+/// - record() is one relaxed increment plus a max update; it is safe to call
+///   from any number of threads.
+///
+/// Typical use:
+///   LatencyHistogram h;
+///   h.record(elapsed_ns);
+///   LatencySummary s = h.summary();
+///
+class LatencyHistogram {
+public:
+	static constexpr unsigned		kSubBits	= 3;
+	static constexpr unsigned		kMaxBits	= 40;
+	static constexpr std::uint64_t	kSubBuckets	= 1u << kSubBits;
+	static constexpr std::size_t	kBuckets	= (kMaxBits - kSubBits + 1) * kSubBuckets;
+
+	void record(std::uint64_t ns) noexcept {
+		buckets_[bucket(ns)].fetch_add(1, std::memory_order_relaxed);
+		std::uint64_t seen = max_.load(std::memory_order_relaxed);
+		while (ns > seen && !max_.compare_exchange_weak(seen, ns, std::memory_order_relaxed)) { }
+	}
+
+	LatencySummary summary() const noexcept {
+		std::array<std::uint64_t, kBuckets> counts;
+		LatencySummary s;
+		for (std::size_t i = 0; i < kBuckets; i++) {
+			counts[i] = buckets_[i].load(std::memory_order_relaxed);
+			s.count += counts[i];
+		}
+		s.max = max_.load(std::memory_order_relaxed);
+		if (s.count == 0) return s;
+		s.p50 = quantile(counts, s.count, 0.50, s.max);
+		s.p90 = quantile(counts, s.count, 0.90, s.max);
+		s.p99 = quantile(counts, s.count, 0.99, s.max);
+		return s;
+	}
+
+private:
+	static std::size_t bucket(std::uint64_t ns) noexcept {
+		if (ns < kSubBuckets) return static_cast<std::size_t>(ns);
+		const unsigned msb = std::bit_width(ns) - 1;
+		if (msb >= kMaxBits) return kBuckets - 1;
+		const std::uint64_t sub = (ns >> (msb - kSubBits)) & (kSubBuckets - 1);
+		return (msb - kSubBits + 1) * kSubBuckets + sub;
+	}
+
+	// Largest value that falls into bucket i.
+	//
+	static std::uint64_t upper_bound(std::size_t i) noexcept {
+		if (i < kSubBuckets) return i;
+		const unsigned msb = static_cast<unsigned>(i / kSubBuckets) + kSubBits - 1;
+		const std::uint64_t sub = i % kSubBuckets;
+		const std::uint64_t base = (kSubBuckets + sub) << (msb - kSubBits);
+		return base + (std::uint64_t{1} << (msb - kSubBits)) - 1;
+	}
+
+	static std::uint64_t quantile(const std::array<std::uint64_t, kBuckets>& counts, std::uint64_t total,
+			double q, std::uint64_t max) noexcept {
+		const auto rank = static_cast<std::uint64_t>(q * static_cast<double>(total - 1)) + 1;
+		std::uint64_t seen = 0;
+		for (std::size_t i = 0; i < kBuckets; i++) {
+			seen += counts[i];
+			if (seen >= rank) return std::min(upper_bound(i), max);
+		}
+		return max;
+	}
+
+	std::array<std::atomic<std::uint64_t>, kBuckets>	buckets_{};
+	std::atomic<std::uint64_t>							max_{0};
+};
+
+#if STEL_EVENT_STATS
+
+// Per-Event counters. publish paths add once per dispatch, not per callback.
+//
+class EventMeter {
+public:
+	void published(std::uint64_t n) noexcept { publishes_.add(n); }
+	void delivered(std::uint64_t n) noexcept { if (n) deliveries_.add(n); }
+	void rebuilt() noexcept { rebuilds_.fetch_add(1, std::memory_order_relaxed); }
+
+	void fill(EventStats& s) const noexcept {
+		s.publishes += publishes_.load();
+		s.deliveries += deliveries_.load();
+		s.rebuilds += rebuilds_.load(std::memory_order_relaxed);
+	}
+
+private:
+	ShardedCounter				publishes_;
+	ShardedCounter				deliveries_;
+	std::atomic<std::uint64_t>	rebuilds_{0};	// Writers only, no need to shard
+};
+
+// Per-subscriber callback latency. Scope times one call.
+//
+class SlotMeter {
+public:
+	class Scope {
+	public:
+		explicit Scope(SlotMeter& m) noexcept : meter_(m), start_(std::chrono::steady_clock::now()) { }
+
+		~Scope() {
+			const auto elapsed = std::chrono::steady_clock::now() - start_;
+			meter_.latency_.record(static_cast<std::uint64_t>(
+					std::chrono::duration_cast<std::chrono::nanoseconds>(elapsed).count()));
+		}
+
+		Scope(const Scope&)				= delete;
+		Scope& operator =(const Scope&)	= delete;
+
+	private:
+		SlotMeter&								meter_;
+		std::chrono::steady_clock::time_point	start_;
+	}; // class Scope
+
+	LatencySummary summary() const noexcept { return latency_.summary(); }
+
+private:
+	LatencyHistogram latency_;
+};
+
+#else
+
+// Stats disabled: same interface, nothing stored, nothing timed.
+//
+class EventMeter {
+public:
+	void published(std::uint64_t) noexcept { }
+	void delivered(std::uint64_t) noexcept { }
+	void rebuilt() noexcept { }
+	void fill(EventStats&) const noexcept { }
+};
+
+class SlotMeter {
+public:
+	class Scope {
+	public:
+		explicit Scope(SlotMeter&) noexcept { }
+	}; // class Scope
+
+	LatencySummary summary() const noexcept { return {}; }
+};
+
+#endif
+
+} // namespace stel
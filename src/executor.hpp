@@ -0,0 +1,120 @@
+#pragma once
+
+#include <cstddef>
+#include <memory>
+#include <thread>
+#include <utility>
+#include <vector>
+
+#include "affinity.hpp"
+#include "dispatcher.hpp"
+#include "inplace_function.hpp"
+
+namespace stel {
+
+using Task = InplaceFunction<void()>;
+
+/// Executor is where queued deliveries (mailboxes, ...) run.
+///
+/// execute(...) may run the task inline or on another thread, but must run
+/// every task it accepts exactly once.
+///
+class Executor {
+public:
+	virtual ~Executor() = default;
+	virtual void execute(Task task) = 0;
+};
+
+/// Runs tasks on the calling thread.
+///
+class InlineExecutor final : public Executor {
+public:
+	void execute(Task task) override { task(); }
+};
+
+/// Fixed pool of threads over an AsyncDispatcher. Tasks are never dropped:
+/// a full queue makes execute() yield until a worker catches up.
+///
+class ThreadPoolExecutor final : public Executor {
+public:
+	explicit ThreadPoolExecutor(std::size_t threads = 1, std::size_t capacity = 1024)
+		: ThreadPoolExecutor(AsyncOptions{threads, capacity, Backpressure::Block, {}}) { }
+
+	// Threads, capacity and CPU pinning from opts; the policy is always Block.
+	//
+	explicit ThreadPoolExecutor(const AsyncOptions& opts)
+		: dispatcher_(blocking(opts), [](Task& task) { task(); }) { }
+
+	void execute(Task task) override { dispatcher_.post(std::move(task)); }
+
+	// Wait until every task accepted so far has run.
+	//
+	void flush() const { dispatcher_.flush(); }
+
+	std::size_t threads() const noexcept { return dispatcher_.threads(); }
+
+private:
+	static AsyncOptions blocking(AsyncOptions opts) {
+		opts.policy = Backpressure::Block;
+		return opts;
+	}
+
+	AsyncDispatcher<Task> dispatcher_;
+};
+
+struct NumaOptions {
+	std::size_t	threads_per_node	= 0;	// 0: one worker per CPU of the node
+	std::size_t	capacity			= 1024;	// Per node queue
+};
+
+/// NumaExecutor keeps one pinned ThreadPoolExecutor per NUMA node, so work
+/// stays on the node it was handed off from.
+///
+/// - execute(task) runs task on a worker of the calling thread's node;
+///   node(i) is an Executor bound to node i, for subscribers that declare an
+///   affinity (pass it as MailboxOptions::executor, StreamOptions, ...).
+/// - Each worker is pinned to one CPU of its node. Each node's queue is
+///   allocated from a thread already pinned to that node, so first-touch
+///   places it in local memory.
+/// - With a single node (or no NUMA information) this is a pinned
+///   ThreadPoolExecutor.
+///
+/// Typical use:
+///   auto numa = std::make_shared<NumaExecutor>();
+///   auto sub = ev->subscribe(cb, MailboxOptions{1024, Backpressure::Block, numa});
+///
+class NumaExecutor final : public Executor {
+public:
+	explicit NumaExecutor(NumaOptions opts = {}, const CpuTopology& topo = CpuTopology::system())
+		: topo_(topo) {
+		for (const NumaNode& n : topo_.nodes()) {
+			AsyncOptions pool{opts.threads_per_node ? opts.threads_per_node : n.cpus.size(),
+					opts.capacity, Backpressure::Block, n.cpus};
+			std::thread([&] {
+				pin_current_thread(n.cpus);
+				nodes_.push_back(std::make_shared<ThreadPoolExecutor>(pool));
+			}).join();
+		}
+	}
+
+	void execute(Task task) override { nodes_[topo_.current_node()]->execute(std::move(task)); }
+
+	std::shared_ptr<Executor> node(std::size_t i) const { return nodes_.at(i); }
+
+	std::size_t node_count() const noexcept { return nodes_.size(); }
+	const CpuTopology& topology() const noexcept { return topo_; }
+
+	// Wait until every task accepted so far, on any node, has run.
+	//
+	void flush() const {
+		for (const auto& n : nodes_) {
+			n->flush();
+		}
+	}
+
+private:
+	const CpuTopology									topo_;
+	std::vector<std::shared_ptr<ThreadPoolExecutor>>	nodes_;
+};
+
+} // namespace stel
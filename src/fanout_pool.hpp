@@ -0,0 +1,201 @@
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+#include "affinity.hpp"
+#include "config.hpp"
+#include "spin_lock.hpp"
+
+namespace stel {
+
+struct FanoutOptions {
+	std::size_t			threads	= 0;	// Helpers besides the caller, 0: one per CPU minus one
+	std::size_t			chunk	= 256;	// Indices per task; smaller loops run serially
+	std::vector<int>	cpus{};			// Helper i pinned to cpus[i % cpus.size()], if any
+};
+
+/// FanoutPool runs the iterations of one loop on the calling thread and a
+/// pool of helpers, for Events broadcasting to thousands of subscribers.
+///
+/// - run(n, fn) splits [0, n) into chunks and hands a reference to the job
+///   to up to one helper per remaining chunk. Every participant, the caller
+///   included, claims chunks from a shared cursor until none are left, so
+///   a busy helper never holds up the loop; the caller returns as soon as
+///   the last chunk has finished (a completion latch), not when every
+///   helper has looked at the job.
+/// - Helpers keep a deque of jobs each. Idle helpers steal from the others'
+///   deques, so a job offered to a helper stuck in a long callback is
+///   picked up elsewhere.
+/// - fn must not throw. run() may be called concurrently and from inside
+///   fn (nested fan-outs complete on the threads that started them).
+///
+/// Typical use:
+///   auto pool = std::make_shared<FanoutPool>(FanoutOptions{7, 256});
+///   auto ev = std::make_shared<Event<Tick>>(pool);
+///
+class FanoutPool {
+public:
+	explicit FanoutPool(FanoutOptions opts = {})
+		: chunk_(std::max<std::size_t>(opts.chunk, 1)) {
+		std::size_t n = opts.threads;
+		if (n == 0) {
+			const unsigned hw = std::thread::hardware_concurrency();
+			n = hw > 1 ? hw - 1 : 1;
+		}
+		queues_ = std::vector<Queue>(n);
+		workers_.reserve(n);
+		for (std::size_t i = 0; i < n; i++) {
+			std::vector<int> cpu;
+			if (!opts.cpus.empty()) cpu.push_back(opts.cpus[i % opts.cpus.size()]);
+			workers_.emplace_back([this, i, cpu = std::move(cpu)] {
+				if (!cpu.empty()) pin_current_thread(cpu);
+				work(i);
+			});
+		}
+	}
+
+	~FanoutPool() {
+		stop_.store(true, std::memory_order_release);
+		signal_.fetch_add(1);
+		signal_.notify_all();
+		for (auto& w : workers_) {
+			w.join();
+		}
+	}
+
+	FanoutPool(const FanoutPool&)				= delete;
+	FanoutPool& operator =(const FanoutPool&)	= delete;
+
+	// Call fn(begin, end) over chunks covering [0, n), returning once all of
+	// them have run. Loops of a single chunk run inline.
+	//
+	template <typename F>
+	void run(std::size_t n, F&& fn) {
+		const std::size_t chunks = (n + chunk_ - 1) / chunk_;
+		if (chunks <= 1) {
+			if (n) fn(std::size_t{0}, n);
+			return;
+		}
+		auto job = std::make_shared<Job>();
+		job->n = n;
+		job->chunk = chunk_;
+		job->chunks = static_cast<std::uint32_t>(chunks);
+		job->ctx = &fn;
+		job->call = [](void* ctx, std::size_t b, std::size_t e) { (*static_cast<std::remove_reference_t<F>*>(ctx))(b, e); };
+
+		const std::size_t helpers = std::min(chunks - 1, queues_.size());
+		const std::size_t first = next_queue_.fetch_add(helpers, std::memory_order_relaxed);
+		for (std::size_t h = 0; h < helpers; h++) {
+			Queue& q = queues_[(first + h) % queues_.size()];
+			std::lock_guard<SpinLock> lk(q.lock);
+			q.jobs.push_back(job);
+		}
+		signal_.fetch_add(1);
+		if (sleepers_.load() > 0) signal_.notify_all();
+
+		job->drain();
+		for (std::uint32_t done; (done = job->done.load(std::memory_order_acquire)) != job->chunks; ) {
+			job->done.wait(done, std::memory_order_acquire);
+		}
+	}
+
+	std::size_t threads() const noexcept { return workers_.size(); }
+	std::size_t chunk() const noexcept { return chunk_; }
+
+	// Jobs a helper took from another helper's deque.
+	//
+	std::uint64_t stolen() const noexcept { return stolen_.load(std::memory_order_relaxed); }
+
+private:
+	struct Job {
+		// Claim and run chunks until none are left.
+		//
+		void drain() {
+			for (;;) {
+				const std::uint32_t i = next.fetch_add(1, std::memory_order_relaxed);
+				if (i >= chunks) return;
+				const std::size_t b = i * chunk;
+				call(ctx, b, std::min(b + chunk, n));
+				if (done.fetch_add(1, std::memory_order_acq_rel) + 1 == chunks) {
+					done.notify_one();
+				}
+			}
+		}
+
+		std::size_t									n = 0;
+		std::size_t									chunk = 0;
+		std::uint32_t								chunks = 0;
+		void*										ctx = nullptr;	// Valid until done == chunks
+		void										(*call)(void*, std::size_t, std::size_t) = nullptr;
+		alignas(cache_line_size) std::atomic<std::uint32_t>	next{0};
+		alignas(cache_line_size) std::atomic<std::uint32_t>	done{0};
+	};
+
+	struct alignas(cache_line_size) Queue {
+		SpinLock							lock;
+		std::deque<std::shared_ptr<Job>>	jobs;	// Owner pops the back, thieves the front
+	};
+
+	std::shared_ptr<Job> take(std::size_t self) {
+		{
+			Queue& q = queues_[self];
+			std::lock_guard<SpinLock> lk(q.lock);
+			if (!q.jobs.empty()) {
+				auto job = std::move(q.jobs.back());
+				q.jobs.pop_back();
+				return job;
+			}
+		}
+		for (std::size_t k = 1; k < queues_.size(); k++) {
+			Queue& q = queues_[(self + k) % queues_.size()];
+			std::lock_guard<SpinLock> lk(q.lock);
+			if (!q.jobs.empty()) {
+				auto job = std::move(q.jobs.front());
+				q.jobs.pop_front();
+				stolen_.fetch_add(1, std::memory_order_relaxed);
+				return job;
+			}
+		}
+		return nullptr;
+	}
+
+	void work(std::size_t self) {
+		for (;;) {
+			if (auto job = take(self)) {
+				job->drain();
+				continue;
+			}
+			const std::uint32_t seen = signal_.load();
+			// Re-check after sampling the signal, a push in between changes it.
+			if (auto job = take(self)) {
+				job->drain();
+				continue;
+			}
+			if (stop_.load(std::memory_order_acquire)) return;
+			sleepers_.fetch_add(1);
+			signal_.wait(seen);
+			sleepers_.fetch_sub(1);
+		}
+	}
+
+	const std::size_t									chunk_;
+	std::vector<Queue>									queues_;
+	std::vector<std::thread>							workers_;
+	alignas(cache_line_size) std::atomic<std::size_t>	next_queue_{0};	// Round-robin start for offers
+	alignas(cache_line_size) std::atomic<std::uint32_t>	signal_{0};
+	std::atomic<std::uint32_t>							sleepers_{0};
+	std::atomic<bool>									stop_{false};
+	std::atomic<std::uint64_t>							stolen_{0};
+};
+
+} // namespace stel
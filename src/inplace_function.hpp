@@ -0,0 +1,144 @@
+#pragma once
+
+#include <cstddef>
+#include <cstring>
+#include <functional>
+#include <new>
+#include <type_traits>
+#include <utility>
+
+namespace stel {
+
+template <typename Signature, std::size_t Capacity = 48>
+class InplaceFunction;
+
+/// InplaceFunction<R(Args...), Capacity> is a move-only std::function
+/// replacement that never allocates.
+///
+/// - The callable is stored inline in Capacity bytes; larger callables are a
+///   compile-time error rather than a silent heap allocation.
+/// - Trivially copyable callables (function pointers, captureless lambdas,
+///   lambdas capturing pointers, bind<&T::fn>(obj)) carry no manager at all:
+///   moving them is a memcpy and destroying them is a no-op.
+/// - The default Capacity makes the whole object 64 bytes, one cache line.
+///
+/// Typical use:
+///   InplaceFunction<void(int)> f = [&](int v) { sum += v; };
+///   auto g = InplaceFunction<void(int)>::bind<&Widget::on_value>(&widget);
+///   f(1); g(2);
+
+template <typename R, typename... Args, std::size_t Capacity>
+class InplaceFunction<R(Args...), Capacity> {
+public:
+	static constexpr std::size_t capacity = Capacity;
+
+	using Invoker = R (*)(void*, Args&&...);
+
+	InplaceFunction() noexcept = default;
+	InplaceFunction(std::nullptr_t) noexcept { }
+
+	template <typename F, typename D = std::decay_t<F>>
+		requires (!std::is_same_v<D, InplaceFunction> && std::is_invocable_r_v<R, D&, Args...>)
+	InplaceFunction(F&& f) {
+		static_assert(sizeof(D) <= Capacity,
+				"callable does not fit InplaceFunction storage, raise Capacity");
+		static_assert(alignof(D) <= alignof(std::max_align_t),
+				"over-aligned callables are not supported");
+		static_assert(std::is_nothrow_move_constructible_v<D>,
+				"callable must be nothrow move constructible");
+
+		if constexpr (std::is_pointer_v<D> || std::is_member_pointer_v<D>) {
+			if (f == nullptr) return;
+		}
+
+		::new (static_cast<void*>(storage_)) D(std::forward<F>(f));
+		invoke_ = [](void* s, Args&&... args) -> R {
+			return std::invoke(*static_cast<D*>(s), std::forward<Args>(args)...);
+		};
+		if constexpr (!(std::is_trivially_copyable_v<D> && std::is_trivially_destructible_v<D>)) {
+			manage_ = [](Op op, void* dst, void* src) noexcept {
+				auto* from = static_cast<D*>(src);
+				if (op == Op::Move) {
+					::new (dst) D(std::move(*from));
+				}
+				from->~D();
+			};
+		}
+	}
+
+	// Member function bound to an object, stored as a single pointer.
+	//
+	template <auto Method, typename T>
+	static InplaceFunction bind(T* obj) noexcept {
+		InplaceFunction f;
+		::new (static_cast<void*>(f.storage_)) T*(obj);
+		f.invoke_ = [](void* s, Args&&... args) -> R {
+			return std::invoke(Method, *static_cast<T**>(s), std::forward<Args>(args)...);
+		};
+		return f;
+	}
+
+	InplaceFunction(InplaceFunction&& other) noexcept { take(other); }
+
+	InplaceFunction& operator =(InplaceFunction&& other) noexcept {
+		if (this != &other) {
+			reset();
+			take(other);
+		}
+		return *this;
+	}
+
+	InplaceFunction& operator =(std::nullptr_t) noexcept {
+		reset();
+		return *this;
+	}
+
+	InplaceFunction(const InplaceFunction&)				= delete;
+	InplaceFunction& operator =(const InplaceFunction&) = delete;
+
+	~InplaceFunction() { reset(); }
+
+	R operator ()(Args... args) const {
+		return invoke_(storage_, std::forward<Args>(args)...);
+	}
+
+	explicit operator bool() const noexcept { return invoke_ != nullptr; }
+
+	// The parts operator() uses, for owners that keep a copy of the invoker
+	// next to other hot data: invoker()(target(), args...) calls the target.
+	// target() is the address of the object itself.
+	//
+	Invoker invoker() const noexcept { return invoke_; }
+	void* target() const noexcept { return storage_; }
+
+private:
+	enum class Op { Move, Destroy };
+
+	using Manager = void (*)(Op, void*, void*) noexcept;
+
+	void take(InplaceFunction& other) noexcept {
+		if (other.manage_) {
+			other.manage_(Op::Move, storage_, other.storage_);
+		} else {
+			std::memcpy(storage_, other.storage_, Capacity);
+		}
+		invoke_ = std::exchange(other.invoke_, nullptr);
+		manage_ = std::exchange(other.manage_, nullptr);
+	}
+
+	void reset() noexcept {
+		if (manage_) {
+			manage_(Op::Destroy, nullptr, storage_);
+		}
+		invoke_ = nullptr;
+		manage_ = nullptr;
+	}
+
+	// Invoking a const InplaceFunction may still mutate the target,
+	// same as std::function. First, see target().
+	alignas(std::max_align_t) mutable unsigned char	storage_[Capacity];
+	Invoker											invoke_ = nullptr;
+	Manager											manage_ = nullptr;
+};
+
+} // namespace stel
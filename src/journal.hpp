@@ -0,0 +1,386 @@
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <bit>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <new>
+#include <stdexcept>
+#include <string>
+#include <system_error>
+#include <thread>
+#include <tuple>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include "config.hpp"
+#include "envelope.hpp"
+#include "executor.hpp"
+#include "inplace_function.hpp"
+#include "mailbox.hpp"
+#include "pod_codec.hpp"
+#include "spin_lock.hpp"
+#include "spsc_ring.hpp"
+
+namespace stel {
+
+struct JournalOptions {
+	std::size_t					depth	= 4096;	// Events kept, rounded up to a power of two
+	// Empty keeps the journal in memory. Otherwise events (trivially copyable
+	// types without pointers, see pod_element) go to this mmap-backed segment
+	// file, which a later journal with the same path, depth and payload
+	// resumes.
+	std::string					path{};
+	std::size_t					queue	= 4096;	// Events between publishers and the journal
+	// Runs appends and follower delivery. Null means a dedicated thread.
+	std::shared_ptr<Executor>	executor{};
+};
+
+/// Journal<Ts...> keeps the last depth() events of a topic and replays them
+/// to late subscribers.
+///
+/// - It subscribes as a queued subscriber (an Inbox): publish only pushes
+///   the shared envelope, as for a Mailbox. Appends happen on the journal's
+///   executor in batches, each batch published with one store.
+/// - Every event gets an offset, counting from 0 (or from where the segment
+///   file left off). first() is the oldest offset still kept, end() the
+///   next one to be written.
+/// - follow(offset, cb) replays from offset and then keeps delivering new
+///   events as they are appended, all from the journal's single drain task,
+///   so the switch to live events has no gap and no duplicate. Followers
+///   that fall more than depth() behind skip ahead and count lost().
+/// - In memory, the journal holds the envelopes themselves (no copy). The
+///   segment file holds PodCodec records in a ring, with end() in its
+///   header; sync() asks the kernel to write it back.
+/// - Follower callbacks that throw are counted in failures().
+///
+/// Typical use (through EventBus):
+///   bus.journal("orders", JournalOptions{1 << 16});
+///   ...
+///   auto from_start = bus.subscribe_from("orders", 0, on_order);
+///
+template <typename... Ts>
+class Journal final : public Inbox<Ts...>, public std::enable_shared_from_this<Journal<Ts...>> {
+public:
+	using Item		= typename Inbox<Ts...>::Item;
+	using Callback	= InplaceFunction<void(const Ts&...), callback_capacity>;
+
+	static constexpr bool mappable = (pod_element<Ts> && ...);
+
+private:
+	struct Follower {
+		Follower(Callback cb, std::uint64_t from) : fn(std::move(cb)), next(from) { }
+
+		Callback					fn;
+		std::uint64_t				next;			// Drain task only
+		std::atomic<std::uint64_t>	position{0};	// next, for readers
+		std::atomic<std::uint64_t>	lost{0};
+		std::atomic<bool>			active{true};
+	};
+
+public:
+	// RAII follower token: destroying it stops delivery. A callback already
+	// running on the journal's executor is not waited for.
+	//
+	class Cursor {
+	public:
+		Cursor() = default;
+		~Cursor() { unsubscribe(); }
+
+		Cursor(Cursor&&) noexcept				= default;
+		Cursor& operator =(Cursor&& other) noexcept {
+			if (this != &other) {
+				unsubscribe();
+				follower_ = std::move(other.follower_);
+			}
+			return *this;
+		}
+
+		void unsubscribe() noexcept {
+			if (follower_) follower_->active.store(false, std::memory_order_release);
+			follower_.reset();
+		}
+
+		explicit operator bool() const noexcept { return follower_ != nullptr; }
+
+		// Offset of the next event this follower will get.
+		//
+		std::uint64_t position() const noexcept {
+			return follower_ ? follower_->position.load(std::memory_order_acquire) : 0;
+		}
+
+		// Events evicted before this follower got to them.
+		//
+		std::uint64_t lost() const noexcept {
+			return follower_ ? follower_->lost.load(std::memory_order_relaxed) : 0;
+		}
+
+	private:
+		friend class Journal;
+		explicit Cursor(std::shared_ptr<Follower> f) noexcept : follower_(std::move(f)) { }
+
+		std::shared_ptr<Follower> follower_;
+	}; // class Cursor
+
+	// Throws std::invalid_argument for a segment file of payloads that are
+	// not trivially copyable or are pointers, or one written for other
+	// payload types, and
+	// std::system_error if the file cannot be mapped.
+	//
+	explicit Journal(const JournalOptions& opts)
+		: queue_(opts.queue)
+		, mask_(std::bit_ceil(opts.depth < 2 ? std::size_t{2} : opts.depth) - 1)
+		, executor_(opts.executor ? opts.executor : std::make_shared<ThreadPoolExecutor>(1)) {
+		if (opts.path.empty()) {
+			events_.resize(mask_ + 1);
+			return;
+		}
+		if constexpr (mappable) {
+			map(opts.path);
+		} else {
+			throw std::invalid_argument("Journal: segment files need trivially copyable payloads without pointers");
+		}
+	}
+
+	~Journal() {
+		if (base_) ::munmap(base_, bytes_);
+	}
+
+	Journal(const Journal&)				= delete;
+	Journal& operator =(const Journal&)	= delete;
+
+	// Replay from offset (clamped to first()), then follow live events.
+	// cb runs on the journal's executor.
+	//
+	[[nodiscard]] Cursor follow(std::uint64_t offset, Callback cb) {
+		auto f = std::make_shared<Follower>(std::move(cb), offset);
+		f->position.store(offset, std::memory_order_relaxed);
+		{
+			std::lock_guard<std::mutex> lk(joining_mtx_);
+			joining_.push_back(f);
+			has_joining_.store(true, std::memory_order_release);
+		}
+		schedule();
+		return Cursor{std::move(f)};
+	}
+
+	std::uint64_t end() const noexcept { return end_.load(std::memory_order_acquire); }
+
+	std::uint64_t first() const noexcept {
+		const std::uint64_t e = end();
+		return e > mask_ + 1 ? e - (mask_ + 1) : 0;
+	}
+
+	std::size_t depth() const noexcept { return mask_ + 1; }
+
+	bool mapped() const noexcept { return base_ != nullptr; }
+
+	std::uint64_t failures() const noexcept { return failures_.load(std::memory_order_relaxed); }
+
+	// Block until every event offered so far is appended and delivered to
+	// the current followers.
+	//
+	void flush() const {
+		while (queued_.load(std::memory_order_acquire) != 0 || has_joining_.load(std::memory_order_acquire)
+				|| scheduled_.load(std::memory_order_acquire)) {
+			std::this_thread::yield();
+		}
+	}
+
+	// Schedule write-back of the segment file (MS_ASYNC). No-op in memory.
+	//
+	void sync() const noexcept {
+		if (base_) ::msync(base_, bytes_, MS_ASYNC);
+	}
+
+	// Inbox, called by the Event.
+	//
+	bool offer(const Item& env) override {
+		if (!open_.load(std::memory_order_acquire)) return false;
+		{
+			std::lock_guard<SpinLock> lk(producer_lock_);
+			queued_.fetch_add(1, std::memory_order_relaxed);
+			while (!queue_.try_push(env)) {
+				std::this_thread::yield();
+			}
+		}
+		schedule();
+		return true;
+	}
+
+	void close() noexcept override { open_.store(false, std::memory_order_release); }
+
+	MailboxStats stats() const noexcept override {
+		return MailboxStats{queue_.size(), end(), 0};
+	}
+
+private:
+	static constexpr std::uint64_t	kMagic		= 0x73746c2d6a726e31;	// "stl-jrn1"
+	static constexpr std::size_t	kDrainBatch	= 256;
+
+	struct Header {
+		std::uint64_t				magic		= 0;
+		std::uint64_t				signature	= 0;
+		std::uint64_t				depth		= 0;
+		std::atomic<std::uint64_t>	end{0};
+	};
+
+	void map(const std::string& path) {
+		using Codec = PodCodec<Ts...>;
+		const int fd = ::open(path.c_str(), O_CREAT | O_RDWR | O_CLOEXEC, 0600);
+		if (fd < 0) throw std::system_error(errno, std::generic_category(), "open");
+		struct stat st;
+		bytes_ = sizeof(Header) + (mask_ + 1) * Codec::size;
+		if (::fstat(fd, &st) != 0) {
+			const int err = errno;
+			::close(fd);
+			throw std::system_error(err, std::generic_category(), "fstat");
+		}
+		const bool fresh = st.st_size == 0;
+		if (fresh && ::ftruncate(fd, static_cast<off_t>(bytes_)) != 0) {
+			const int err = errno;
+			::close(fd);
+			throw std::system_error(err, std::generic_category(), "ftruncate");
+		}
+		if (!fresh && static_cast<std::size_t>(st.st_size) != bytes_) {
+			::close(fd);
+			throw std::invalid_argument("Journal: segment file has another depth or payload");
+		}
+		void* p = ::mmap(nullptr, bytes_, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+		const int err = errno;
+		::close(fd);
+		if (p == MAP_FAILED) throw std::system_error(err, std::generic_category(), "mmap");
+		base_ = static_cast<unsigned char*>(p);
+
+		Header& h = header();
+		if (fresh) {
+			::new (base_) Header();
+			h.signature = Codec::signature;
+			h.depth = mask_ + 1;
+			h.magic = kMagic;
+		} else if (h.magic != kMagic || h.signature != Codec::signature || h.depth != mask_ + 1) {
+			::munmap(base_, bytes_);
+			base_ = nullptr;
+			throw std::invalid_argument("Journal: segment file has another depth or payload");
+		}
+		const std::uint64_t resumed = h.end.load(std::memory_order_relaxed);
+		end_.store(resumed, std::memory_order_relaxed);
+	}
+
+	Header& header() const noexcept { return *std::launder(reinterpret_cast<Header*>(base_)); }
+
+	unsigned char* record(std::uint64_t offset) const noexcept {
+		return base_ + sizeof(Header) + (offset & mask_) * PodCodec<Ts...>::size;
+	}
+
+	void schedule() {
+		if (!scheduled_.exchange(true, std::memory_order_acq_rel)) {
+			executor_->execute([self = this->shared_from_this()] { self->drain(); });
+		}
+	}
+
+	void append(const Item& env, std::uint64_t offset) {
+		if (!base_) {
+			events_[offset & mask_] = env;
+			return;
+		}
+		if constexpr (mappable) {
+			std::apply([&](const Ts&... args) { PodCodec<Ts...>::encode(record(offset), args...); }, *env);
+		}
+	}
+
+	template <typename F>
+	void read(std::uint64_t offset, F&& fn) const {
+		if (!base_) {
+			std::apply(fn, *events_[offset & mask_]);
+			return;
+		}
+		if constexpr (mappable) {
+			PodCodec<Ts...>::decode(record(offset), fn);
+		}
+	}
+
+	// The only writer of the journal and the only caller of followers.
+	// Joining followers catch up before the batch is appended, so a batch
+	// only evicts what they had a chance to read.
+	//
+	void drain() {
+		if (has_joining_.exchange(false, std::memory_order_acq_rel)) {
+			{
+				std::lock_guard<std::mutex> lk(joining_mtx_);
+				followers_.insert(followers_.end(), joining_.begin(), joining_.end());
+				joining_.clear();
+			}
+			deliver();
+		}
+
+		std::uint64_t end = end_.load(std::memory_order_relaxed);
+		Item item;
+		std::size_t n = 0;
+		for (; n < kDrainBatch && queue_.try_pop(item); n++) {
+			append(item, end++);
+		}
+		item.reset();
+		if (n) {
+			if (base_) header().end.store(end, std::memory_order_release);
+			end_.store(end, std::memory_order_release);
+			deliver();
+		}
+		queued_.fetch_sub(n, std::memory_order_release);
+
+		scheduled_.exchange(false, std::memory_order_acq_rel);
+		if (!queue_.empty() || has_joining_.load(std::memory_order_acquire)) {
+			schedule();
+		}
+	}
+
+	// Bring every follower up to end().
+	//
+	void deliver() {
+		const std::uint64_t oldest = first();
+		const std::uint64_t end = end_.load(std::memory_order_relaxed);
+		std::erase_if(followers_, [](const auto& f) { return !f->active.load(std::memory_order_acquire); });
+		for (const auto& f : followers_) {
+			if (f->next < oldest) {
+				f->lost.fetch_add(oldest - f->next, std::memory_order_relaxed);
+				f->next = oldest;
+			}
+			for (; f->next < end && f->active.load(std::memory_order_relaxed); f->next++) {
+				try {
+					read(f->next, f->fn);
+				} catch (...) {
+					failures_.fetch_add(1, std::memory_order_relaxed);
+				}
+			}
+			f->position.store(f->next, std::memory_order_release);
+		}
+	}
+
+	SpscRing<Item>										queue_;
+	const std::size_t									mask_;
+	std::shared_ptr<Executor>							executor_;
+	std::vector<Item>									events_;	// In memory: the ring itself
+	unsigned char*										base_ = nullptr;	// Segment file mapping
+	std::size_t											bytes_ = 0;
+	std::vector<std::shared_ptr<Follower>>				followers_;	// Drain task only
+	std::mutex											joining_mtx_;
+	std::vector<std::shared_ptr<Follower>>				joining_;	// Requires joining_mtx_
+	std::atomic<bool>									has_joining_{false};
+	std::atomic<bool>									open_{true};
+	std::atomic<std::uint64_t>							failures_{0};
+	alignas(cache_line_size) SpinLock					producer_lock_;
+	std::atomic<std::size_t>							queued_{0};	// Offered, not yet appended
+	alignas(cache_line_size) std::atomic<bool>			scheduled_{false};
+	std::atomic<std::uint64_t>							end_{0};
+};
+
+} // namespace stel
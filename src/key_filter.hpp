@@ -0,0 +1,60 @@
+#pragma once
+
+#include <string>
+#include <string_view>
+#include <type_traits>
+#include <utility>
+
+namespace stel {
+
+// Equality filter: deliver only events whose projected key equals key.
+// Built with KeyProjection::is().
+//
+template <typename Proj, typename V>
+struct KeyFilter {
+	Proj	proj;
+	V		key;
+};
+
+/// KeyProjection<Proj> names a key extracted from an event, e.g. its symbol.
+///
+/// - Subscribing with filter.is(value) puts the subscriber into a per-Event
+///   hash index keyed by the projection, so publish computes the key once
+///   and only calls the subscribers of that key.
+/// - The index is identified by the projection's type and, unless the type is
+///   stateless, its value: key_of(&by_symbol) and key_of(&by_venue) are two
+///   indexes. Stateful projections must be comparable with ==. Define a
+///   projection once and reuse it, rather than writing a fresh lambda per
+///   subscribe.
+/// - Keys nobody subscribes to any more are dropped from the index in
+///   batches, so it does not grow with every key ever seen.
+/// - A projection returning std::string_view is indexed by std::string.
+///
+/// Typical use:
+///   inline constexpr auto by_symbol = key_of([](const Tick& t) { return std::string_view(t.symbol); });
+///   auto sub = ev->subscribe(by_symbol.is("AAPL"), [](const Tick& t) { ... });
+///
+template <typename Proj>
+class KeyProjection {
+public:
+	constexpr explicit KeyProjection(Proj proj) : proj_(std::move(proj)) { }
+
+	template <typename V>
+	KeyFilter<Proj, std::decay_t<V>> is(V&& key) const {
+		return {proj_, std::forward<V>(key)};
+	}
+
+private:
+	Proj proj_;
+};
+
+template <typename Proj>
+constexpr KeyProjection<Proj> key_of(Proj proj) { return KeyProjection<Proj>(std::move(proj)); }
+
+// Index key type for a projection result.
+//
+template <typename Key>
+using index_key_t = std::conditional_t<std::is_same_v<std::decay_t<Key>, std::string_view>,
+		std::string, std::decay_t<Key>>;
+
+} // namespace stel
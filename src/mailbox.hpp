@@ -0,0 +1,166 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <stdexcept>
+#include <thread>
+#include <tuple>
+#include <utility>
+
+#include "config.hpp"
+#include "dispatcher.hpp"
+#include "envelope.hpp"
+#include "error_sink.hpp"
+#include "executor.hpp"
+#include "inplace_function.hpp"
+#include "spin_lock.hpp"
+#include "spsc_ring.hpp"
+
+namespace stel {
+
+struct MailboxOptions {
+	std::size_t					capacity	= 1024;	// Rounded up to a power of two
+	Backpressure				overflow	= Backpressure::Block;
+	// Null means a dedicated drain thread for this subscriber.
+	std::shared_ptr<Executor>	executor;
+};
+
+struct MailboxStats {
+	std::size_t		queued		= 0;
+	std::uint64_t	delivered	= 0;
+	std::uint64_t	dropped		= 0;
+};
+
+// A subscriber's private delivery queue, as seen by its Event.
+//
+template <typename... Ts>
+class Inbox {
+public:
+	using Item = EnvelopePtr<Ts...>;
+
+	virtual ~Inbox() = default;
+
+	// Returns false if the item was dropped (full or closed).
+	//
+	virtual bool offer(const Item& env) = 0;
+
+	// Stops delivery; anything still pending is discarded.
+	//
+	virtual void close() noexcept = 0;
+
+	// The Event is gone: no more offers will come, pending ones still count.
+	//
+	virtual void finish() noexcept { }
+
+	virtual MailboxStats stats() const noexcept = 0;
+};
+
+/// Mailbox<Ts...> is the private, bounded queue of one subscriber.
+///
+/// - offer(...) pushes a shared EnvelopePtr into an SpscRing, so the payload
+///   is never copied per subscriber. Publishers on several threads are
+///   serialized by a tiny spin lock that is uncontended with one publisher.
+/// - A drain task is posted to the executor only when the mailbox goes from
+///   idle to non-empty; it then delivers in batches and re-arms itself.
+/// - Overflow is per subscriber: Block waits for the drain to catch up,
+///   DropNewest discards and counts. DropOldest would need the producer to
+///   pop, which SPSC rules out; use a conflating subscription for that.
+/// - Exceptions thrown by the handler go to errors, tagged with id; the
+///   mailbox keeps draining.
+/// - close() stops delivery; anything still queued is discarded.
+
+template <typename... Ts>
+class Mailbox final : public Inbox<Ts...>, public std::enable_shared_from_this<Mailbox<Ts...>> {
+public:
+	using Handler	= InplaceFunction<void(const Ts&...), callback_capacity>;
+	using Item		= typename Inbox<Ts...>::Item;
+
+	Mailbox(const MailboxOptions& opts, Handler handler,
+			std::shared_ptr<ErrorSink> errors = nullptr, std::size_t id = 0)
+		: ring_(opts.capacity)
+		, handler_(std::move(handler))
+		, errors_(std::move(errors))
+		, id_(id)
+		, executor_(opts.executor ? opts.executor : std::make_shared<ThreadPoolExecutor>(1))
+		, policy_(opts.overflow) {
+		if (policy_ == Backpressure::DropOldest) {
+			throw std::invalid_argument("Mailbox does not support Backpressure::DropOldest");
+		}
+	}
+
+	Mailbox(const Mailbox&)				= delete;
+	Mailbox& operator =(const Mailbox&)	= delete;
+
+	bool offer(const Item& env) override {
+		if (!open_.load(std::memory_order_acquire)) return false;
+		{
+			std::lock_guard<SpinLock> lk(producer_lock_);
+			while (!ring_.try_push(env)) {
+				if (policy_ == Backpressure::DropNewest) {
+					dropped_.fetch_add(1, std::memory_order_relaxed);
+					return false;
+				}
+				std::this_thread::yield();
+			}
+		}
+		schedule();
+		return true;
+	}
+
+	void close() noexcept override { open_.store(false, std::memory_order_release); }
+
+	MailboxStats stats() const noexcept override {
+		return MailboxStats{
+			ring_.size(),
+			delivered_.load(std::memory_order_relaxed),
+			dropped_.load(std::memory_order_relaxed),
+		};
+	}
+
+private:
+	// Upper bound on items delivered per drain task, so mailboxes sharing an
+	// executor take turns.
+	static constexpr std::size_t kDrainBatch = 256;
+
+	void schedule() {
+		// Both sides RMW scheduled_, which orders a push against the drain's
+		// final emptiness check, no wakeup can be lost.
+		if (!scheduled_.exchange(true, std::memory_order_acq_rel)) {
+			executor_->execute([self = this->shared_from_this()] { self->drain(); });
+		}
+	}
+
+	void drain() {
+		Item item;
+		for (std::size_t n = 0; n < kDrainBatch && ring_.try_pop(item); n++) {
+			if (!open_.load(std::memory_order_acquire)) continue;
+			try {
+				std::apply(handler_, *item);
+			} catch (...) {
+				if (errors_) errors_->report(id_, std::current_exception());
+			}
+			delivered_.fetch_add(1, std::memory_order_relaxed);
+		}
+		item.reset();
+		scheduled_.exchange(false, std::memory_order_acq_rel);
+		if (!ring_.empty()) {
+			schedule();
+		}
+	}
+
+	SpscRing<Item>										ring_;
+	Handler												handler_;
+	std::shared_ptr<ErrorSink>							errors_;	// Null swallows
+	const std::size_t									id_;
+	std::shared_ptr<Executor>							executor_;
+	const Backpressure									policy_;
+	std::atomic<bool>									open_{true};
+	alignas(cache_line_size) SpinLock					producer_lock_;
+	std::atomic<std::uint64_t>							dropped_{0};	// Producer side
+	alignas(cache_line_size) std::atomic<bool>			scheduled_{false};
+	std::atomic<std::uint64_t>							delivered_{0};	// Consumer side
+};
+
+} // namespace stel
@@ -0,0 +1,108 @@
+#pragma once
+
+#include <atomic>
+#include <bit>
+#include <cstddef>
+#include <memory>
+#include <new>
+#include <utility>
+
+#include "config.hpp"
+
+namespace stel {
+
+/// MpmcQueue<T> is a bounded lock-free multi-producer/multi-consumer queue
+/// (Dmitry Vyukov's design).
+///
+/// - Every cell carries a sequence number that tells producers and consumers
+///   whose turn it is, so a push or pop is one CAS on the shared position
+///   plus a release store on the cell.
+/// - Capacity is rounded up to a power of two and fixed at construction,
+///   memory never grows under bursts.
+/// - try_push/try_pop never block; callers choose what to do when full.
+
+template <typename T>
+class MpmcQueue {
+public:
+	explicit MpmcQueue(std::size_t capacity)
+		: mask_(std::bit_ceil(capacity < 2 ? std::size_t{2} : capacity) - 1)
+		, cells_(new Cell[mask_ + 1]) {
+		for (std::size_t i = 0; i <= mask_; i++) {
+			cells_[i].seq.store(i, std::memory_order_relaxed);
+		}
+	}
+
+	~MpmcQueue() {
+		T item;
+		while (try_pop(item)) { }
+	}
+
+	MpmcQueue(const MpmcQueue&)				= delete;
+	MpmcQueue& operator =(const MpmcQueue&)	= delete;
+
+	template <typename U>
+	bool try_push(U&& item) {
+		std::size_t pos = enqueue_pos_.load(std::memory_order_relaxed);
+		for (;;) {
+			Cell& cell = cells_[pos & mask_];
+			const std::size_t seq = cell.seq.load(std::memory_order_acquire);
+			const auto diff = static_cast<std::ptrdiff_t>(seq) - static_cast<std::ptrdiff_t>(pos);
+			if (diff == 0) {
+				if (enqueue_pos_.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed)) {
+					::new (cell.storage) T(std::forward<U>(item));
+					cell.seq.store(pos + 1, std::memory_order_release);
+					return true;
+				}
+			} else if (diff < 0) {
+				return false; // Full
+			} else {
+				pos = enqueue_pos_.load(std::memory_order_relaxed);
+			}
+		}
+	}
+
+	bool try_pop(T& out) {
+		std::size_t pos = dequeue_pos_.load(std::memory_order_relaxed);
+		for (;;) {
+			Cell& cell = cells_[pos & mask_];
+			const std::size_t seq = cell.seq.load(std::memory_order_acquire);
+			const auto diff = static_cast<std::ptrdiff_t>(seq) - static_cast<std::ptrdiff_t>(pos + 1);
+			if (diff == 0) {
+				if (dequeue_pos_.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed)) {
+					T* item = std::launder(reinterpret_cast<T*>(cell.storage));
+					out = std::move(*item);
+					item->~T();
+					cell.seq.store(pos + mask_ + 1, std::memory_order_release);
+					return true;
+				}
+			} else if (diff < 0) {
+				return false; // Empty
+			} else {
+				pos = dequeue_pos_.load(std::memory_order_relaxed);
+			}
+		}
+	}
+
+	std::size_t capacity() const noexcept { return mask_ + 1; }
+
+	// Approximate, for monitoring only.
+	//
+	std::size_t size() const noexcept {
+		const std::size_t head = dequeue_pos_.load(std::memory_order_relaxed);
+		const std::size_t tail = enqueue_pos_.load(std::memory_order_relaxed);
+		return tail > head ? tail - head : 0;
+	}
+
+private:
+	struct Cell {
+		std::atomic<std::size_t>			seq;
+		alignas(T) unsigned char			storage[sizeof(T)];
+	};
+
+	const std::size_t										mask_;
+	std::unique_ptr<Cell[]>									cells_;
+	alignas(cache_line_size) std::atomic<std::size_t>		enqueue_pos_{0};
+	alignas(cache_line_size) std::atomic<std::size_t>		dequeue_pos_{0};
+};
+
+} // namespace stel
@@ -0,0 +1,134 @@
+#pragma once
+
+#include <array>
+#include <bit>
+#include <concepts>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <string_view>
+#include <tuple>
+#include <type_traits>
+#include <utility>
+
+namespace stel {
+
+// Whether T travels as a PodCodec element: trivially copyable, and not a
+// pointer, whose value means nothing in another process or after a restart.
+// Pointers inside a struct can't be seen from here; keep them out by hand.
+//
+template <typename T>
+inline constexpr bool pod_element = std::is_trivially_copyable_v<T>
+		&& !std::is_pointer_v<std::remove_all_extents_t<T>>
+		&& !std::is_member_pointer_v<std::remove_all_extents_t<T>>;
+
+// T as the compiler spells it ("Quote", "std::array<int, 4>"), used to tag
+// PodCodec signatures.
+//
+template <typename T>
+constexpr std::string_view pod_type_name() noexcept {
+	const std::string_view f = __PRETTY_FUNCTION__;	// "... [with T = Quote; ...]", "... [T = Quote]"
+	const std::size_t from = f.find("T = ") + 4;
+	return f.substr(from, f.find_first_of(";]", from) - from);
+}
+
+// A payload type may declare `static constexpr std::uint64_t pod_version`
+// and bump it when its fields change meaning without changing layout.
+//
+template <typename T>
+constexpr std::uint64_t pod_version() noexcept {
+	if constexpr (requires { { T::pod_version } -> std::convertible_to<std::uint64_t>; }) {
+		return T::pod_version;
+	} else {
+		return 0;
+	}
+}
+
+/// PodCodec<Ts...> lays trivially copyable arguments out back to back in a
+/// fixed-size byte record, each element at its natural alignment.
+///
+/// - encode(...) and decode(...) are plain memcpys, usable on mapped or
+///   received memory of any alignment.
+/// - signature identifies the record: element count, and each element's type
+///   name, size, alignment and pod_version (see above), so peers can refuse
+///   records they would misread. Renaming a payload type changes it too.
+///   Host byte order is kept: records only travel between machines of the
+///   same endianness.
+/// - Pointer elements don't compile (see pod_element).
+///
+/// Typical use:
+///   using Codec = PodCodec<int, double>;
+///   unsigned char buf[Codec::size];
+///   Codec::encode(buf, 1, 2.0);
+///   Codec::decode(buf, [](int a, double b) { ... });
+///
+template <typename... Ts>
+struct PodCodec {
+	static_assert((pod_element<Ts> && ...), "PodCodec payloads must be trivially copyable and hold no pointers");
+
+	// Byte offset of each element, plus the total size last.
+	//
+	static constexpr std::array<std::size_t, sizeof...(Ts) + 1> offsets = [] {
+		std::array<std::size_t, sizeof...(Ts) + 1> offs{};
+		constexpr std::size_t sizes[] = {sizeof(Ts)..., 0};
+		constexpr std::size_t aligns[] = {alignof(Ts)..., 1};
+		std::size_t at = 0;
+		for (std::size_t i = 0; i < sizeof...(Ts); i++) {
+			at = (at + aligns[i] - 1) / aligns[i] * aligns[i];
+			offs[i] = at;
+			at += sizes[i];
+		}
+		offs[sizeof...(Ts)] = at;
+		return offs;
+	}();
+
+	static constexpr std::size_t size = offsets[sizeof...(Ts)];
+
+	static constexpr std::uint64_t signature = [] {
+		std::uint64_t h = 14695981039346656037ull;
+		const auto mix = [&](std::uint64_t v) { h = (h ^ v) * 1099511628211ull; };
+		mix(sizeof...(Ts));
+		([&] {
+			for (char c : pod_type_name<Ts>()) mix(static_cast<unsigned char>(c));
+			mix(sizeof(Ts));
+			mix(alignof(Ts));
+			mix(pod_version<Ts>());
+		}(), ...);
+		return h;
+	}();
+
+	static void encode(unsigned char* out, const Ts&... args) noexcept {
+		encode(out, std::index_sequence_for<Ts...>{}, args...);
+	}
+
+	static std::tuple<Ts...> load(const unsigned char* in) noexcept {
+		return load(in, std::index_sequence_for<Ts...>{});
+	}
+
+	// Call fn(const Ts&...) with the record at in.
+	//
+	template <typename F>
+	static decltype(auto) decode(const unsigned char* in, F&& fn) {
+		return std::apply(std::forward<F>(fn), load(in));
+	}
+
+private:
+	template <std::size_t... I>
+	static void encode(unsigned char* out, std::index_sequence<I...>, const Ts&... args) noexcept {
+		(std::memcpy(out + offsets[I], &args, sizeof(Ts)), ...);
+	}
+
+	template <typename T>
+	static T load_one(const unsigned char* at) noexcept {
+		std::array<unsigned char, sizeof(T)> raw;
+		std::memcpy(raw.data(), at, sizeof(T));
+		return std::bit_cast<T>(raw);
+	}
+
+	template <std::size_t... I>
+	static std::tuple<Ts...> load(const unsigned char* in, std::index_sequence<I...>) noexcept {
+		return std::tuple<Ts...>(load_one<Ts>(in + offsets[I])...);
+	}
+};
+
+} // namespace stel
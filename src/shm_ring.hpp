@@ -0,0 +1,390 @@
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <bit>
+#include <chrono>
+#include <climits>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <memory>
+#include <new>
+#include <string>
+#include <system_error>
+#include <thread>
+#include <utility>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#if defined(__linux__)
+#include <linux/futex.h>
+#include <sys/syscall.h>
+#endif
+
+#include "config.hpp"
+#include "event.hpp"
+#include "pod_codec.hpp"
+
+namespace stel {
+
+/// ShmRing<Ts...> carries events of trivially copyable types between
+/// processes through a named POSIX shared memory ring.
+///
+/// - One ring per topic. Any number of processes may publish into it and
+///   any number may read from it; every reader sees every event (broadcast).
+/// - publish(...) claims a position with one fetch_add and writes the slot
+///   under a per-slot sequence number (seqlock), then bumps a futex word.
+///   It never blocks and never enters the kernel unless a reader sleeps.
+/// - Readers keep their own cursor. A reader more than capacity() events
+///   behind is lapped: it skips ahead to the oldest event still in the ring
+///   and counts the ones it missed in lost().
+/// - Payloads are copied word by word; no serializer, no kernel copy.
+/// - A publisher descheduled between claiming a position and finishing its
+///   slot holds every reader at that position: later events wait until it
+///   finishes, or until the ring laps the slot and readers skip it (counted
+///   in lost()). Size the ring so a lap takes longer than any publisher can
+///   be descheduled.
+///
+/// Typical use:
+///   // Process A
+///   auto ring = ShmRing<Quote>::create("/quotes", 4096);
+///   auto sub = shm_export(quotes_event, ring);
+///
+///   // Process B
+///   auto ring = ShmRing<Quote>::open("/quotes");
+///   ShmImport<Quote> in(ring, local_event);	// Reader thread publishing locally
+///
+template <typename... Ts>
+class ShmRing : public std::enable_shared_from_this<ShmRing<Ts...>> {
+	static_assert(sizeof...(Ts) > 0, "ShmRing needs a payload");
+
+public:
+	class Reader;
+
+	// Create the ring called name, which follows shm_open() rules ("/topic").
+	// Never touches an existing segment, live or stale: that throws
+	// std::system_error with EEXIST, so unlink() a ring left behind by a
+	// crashed process before creating it again. Throws std::system_error.
+	//
+	static std::shared_ptr<ShmRing> create(const std::string& name, std::size_t capacity) {
+		const std::size_t cap = std::bit_ceil(capacity < 2 ? std::size_t{2} : capacity);
+		const int fd = ::shm_open(name.c_str(), O_CREAT | O_EXCL | O_RDWR, 0600);
+		if (fd < 0) throw_errno("shm_open");
+		const std::size_t bytes = sizeof(Header) + cap * kStride;
+		if (::ftruncate(fd, static_cast<off_t>(bytes)) != 0) {
+			const int err = errno;
+			::close(fd);
+			unlink(name);
+			throw std::system_error(err, std::generic_category(), "ftruncate");
+		}
+		std::shared_ptr<ShmRing> ring;
+		try {
+			ring = std::shared_ptr<ShmRing>(new ShmRing(fd, bytes));
+		} catch (...) {
+			unlink(name);	// Half-made; don't leave it to block the next create()
+			throw;
+		}
+		auto* h = ::new (ring->base_) Header();
+		h->capacity = cap;
+		h->stride = kStride;
+		h->signature = kSignature;
+		for (std::size_t i = 0; i < cap; i++) {
+			::new (ring->slot_at(i)) Slot();
+		}
+		h->magic.store(kMagic, std::memory_order_release);
+		return ring;
+	}
+
+	// Map an existing ring. Throws std::system_error if it does not exist
+	// and std::invalid_argument if it was created for other payload types.
+	//
+	static std::shared_ptr<ShmRing> open(const std::string& name) {
+		const int fd = ::shm_open(name.c_str(), O_RDWR, 0600);
+		if (fd < 0) throw_errno("shm_open");
+		struct stat st;
+		if (::fstat(fd, &st) != 0) {
+			const int err = errno;
+			::close(fd);
+			throw std::system_error(err, std::generic_category(), "fstat");
+		}
+		const auto bytes = static_cast<std::size_t>(st.st_size);
+		if (bytes < sizeof(Header)) {
+			::close(fd);
+			throw std::invalid_argument("ShmRing: not a ring");
+		}
+		auto ring = std::shared_ptr<ShmRing>(new ShmRing(fd, bytes));
+		const Header& h = ring->header();
+		if (h.magic.load(std::memory_order_acquire) != kMagic || h.signature != kSignature
+				|| h.stride != kStride || sizeof(Header) + h.capacity * kStride > bytes) {
+			throw std::invalid_argument("ShmRing: ring has another layout or payload");
+		}
+		return ring;
+	}
+
+	// Remove the name; mappings stay valid until they are dropped.
+	//
+	static void unlink(const std::string& name) noexcept { ::shm_unlink(name.c_str()); }
+
+	~ShmRing() { ::munmap(base_, bytes_); }
+
+	ShmRing(const ShmRing&)				= delete;
+	ShmRing& operator =(const ShmRing&)	= delete;
+
+	void publish(const Ts&... args) noexcept {
+		Header& h = header();
+		const std::uint64_t pos = h.head.fetch_add(1, std::memory_order_relaxed);
+		Slot& s = *slot_at(pos & (h.capacity - 1));
+
+		alignas(std::uint64_t) unsigned char bytes[kWords * 8] = {};
+		Codec::encode(bytes, args...);
+
+		s.seq.store(writing(pos), std::memory_order_relaxed);
+		std::atomic_thread_fence(std::memory_order_release);
+		for (std::size_t i = 0; i < kWords; i++) {
+			std::uint64_t w;
+			std::memcpy(&w, bytes + i * 8, 8);
+			std::atomic_ref<std::uint64_t>(s.words[i]).store(w, std::memory_order_relaxed);
+		}
+		s.seq.store(done(pos), std::memory_order_release);
+
+		// Pairs with the seq_cst increment in Reader::wait(): either it sees
+		// our signal, or we see it sleeping.
+		h.signal.fetch_add(1, std::memory_order_seq_cst);
+		if (h.sleepers.load(std::memory_order_seq_cst) != 0) {
+			futex_wake(&h.signal);
+		}
+	}
+
+	// A reader starting after the last published event.
+	//
+	Reader reader() { return Reader(this->shared_from_this()); }
+
+	std::size_t capacity() const noexcept { return header().capacity; }
+
+	// Events published so far, by every process.
+	//
+	std::uint64_t published() const noexcept { return header().head.load(std::memory_order_relaxed); }
+
+	/// Reader is one consumer's cursor into a ShmRing. Not thread-safe.
+	///
+	class Reader {
+	public:
+		// Deliver up to max available events to fn(const Ts&...), returns
+		// how many were delivered.
+		//
+		template <typename F>
+		std::size_t poll(F&& fn, std::size_t max = SIZE_MAX) {
+			std::size_t n = 0;
+			while (n < max && read(fn)) {
+				++n;
+			}
+			return n;
+		}
+
+		// Sleep until an event may be available, interrupt() is called or
+		// timeout expires. Returns true if an event is available.
+		//
+		bool wait(std::chrono::nanoseconds timeout) {
+			Header& h = ring_->header();
+			const std::uint32_t signal = h.signal.load(std::memory_order_acquire);
+			if (available()) return true;
+			h.sleepers.fetch_add(1, std::memory_order_seq_cst);
+			if (h.signal.load(std::memory_order_seq_cst) == signal && !available()) {
+				futex_wait(&h.signal, signal, timeout);
+			}
+			h.sleepers.fetch_sub(1, std::memory_order_relaxed);
+			return available();
+		}
+
+		// Wake a wait() on this ring, in any process, e.g. to stop it.
+		//
+		void interrupt() noexcept {
+			Header& h = ring_->header();
+			h.signal.fetch_add(1, std::memory_order_seq_cst);
+			futex_wake(&h.signal);
+		}
+
+		// Events overwritten before this reader got to them.
+		//
+		std::uint64_t lost() const noexcept { return lost_; }
+
+	private:
+		friend class ShmRing;
+
+		explicit Reader(std::shared_ptr<ShmRing> ring)
+			: ring_(std::move(ring)), next_(ring_->header().head.load(std::memory_order_acquire)) { }
+
+		bool available() const noexcept {
+			const Header& h = ring_->header();
+			return ring_->slot_at(next_ & (h.capacity - 1))->seq.load(std::memory_order_acquire) >= done(next_);
+		}
+
+		template <typename F>
+		bool read(F& fn) {
+			const Header& h = ring_->header();
+			for (;;) {
+				const Slot& s = *ring_->slot_at(next_ & (h.capacity - 1));
+				const std::uint64_t seq = s.seq.load(std::memory_order_acquire);
+				if (seq < done(next_)) return false;	// Not written yet
+				if (seq == done(next_)) {
+					alignas(std::uint64_t) unsigned char bytes[kWords * 8];
+					for (std::size_t i = 0; i < kWords; i++) {
+						const std::uint64_t w = std::atomic_ref<std::uint64_t>(
+								const_cast<std::uint64_t&>(s.words[i])).load(std::memory_order_relaxed);
+						std::memcpy(bytes + i * 8, &w, 8);
+					}
+					std::atomic_thread_fence(std::memory_order_acquire);
+					if (s.seq.load(std::memory_order_relaxed) == seq) {
+						++next_;
+						Codec::decode(bytes, fn);
+						return true;
+					}
+				}
+				// Lapped: resume at the oldest event that can still be intact.
+				const std::uint64_t head = h.head.load(std::memory_order_acquire);
+				const std::uint64_t oldest = head > h.capacity ? head - h.capacity : 0;
+				const std::uint64_t resume = std::max(oldest, next_ + 1);
+				lost_ += resume - next_;
+				next_ = resume;
+			}
+		}
+
+		std::shared_ptr<ShmRing>	ring_;
+		std::uint64_t				next_;
+		std::uint64_t				lost_ = 0;
+	}; // class Reader
+
+private:
+	static constexpr std::uint64_t kMagic = 0x73746c2d73686d31;	// "stl-shm1"
+
+	using Codec = PodCodec<Ts...>;
+
+	static constexpr std::size_t kWords		= std::max<std::size_t>(1, (Codec::size + 7) / 8);
+	static constexpr std::size_t kStride	= ((8 + kWords * 8) + cache_line_size - 1) / cache_line_size * cache_line_size;
+
+	// Rejects opening a ring with a different payload layout.
+	//
+	static constexpr std::uint64_t kSignature = Codec::signature;
+
+	static_assert(std::atomic<std::uint64_t>::is_always_lock_free && std::atomic<std::uint32_t>::is_always_lock_free,
+			"ShmRing needs address-free atomics");
+
+	struct Header {
+		std::atomic<std::uint64_t>							magic{0};	// Set last by create()
+		std::uint64_t										capacity	= 0;
+		std::uint64_t										stride		= 0;
+		std::uint64_t										signature	= 0;
+		alignas(cache_line_size) std::atomic<std::uint64_t>	head{0};	// Next position to claim
+		alignas(cache_line_size) std::atomic<std::uint32_t>	signal{0};	// Futex word, bumped per publish
+		std::atomic<std::uint32_t>							sleepers{0};
+	};
+
+	struct alignas(cache_line_size) Slot {
+		std::atomic<std::uint64_t>	seq{0};		// writing(pos) while written, then done(pos)
+		std::uint64_t				words[kWords];
+	};
+
+	static_assert(sizeof(Slot) == kStride);
+
+	static constexpr std::uint64_t writing(std::uint64_t pos) noexcept { return 2 * pos + 1; }
+	static constexpr std::uint64_t done(std::uint64_t pos) noexcept { return 2 * pos + 2; }
+
+	ShmRing(int fd, std::size_t bytes) : bytes_(bytes) {
+		void* p = ::mmap(nullptr, bytes, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+		const int err = errno;
+		::close(fd);
+		if (p == MAP_FAILED) throw std::system_error(err, std::generic_category(), "mmap");
+		base_ = static_cast<unsigned char*>(p);
+	}
+
+	[[noreturn]] static void throw_errno(const char* what) {
+		throw std::system_error(errno, std::generic_category(), what);
+	}
+
+	Header& header() const noexcept { return *std::launder(reinterpret_cast<Header*>(base_)); }
+
+	Slot* slot_at(std::size_t i) const noexcept {
+		return std::launder(reinterpret_cast<Slot*>(base_ + sizeof(Header) + i * kStride));
+	}
+
+	// Shared (not FUTEX_PRIVATE) futexes, the word lives in another process
+	// too. Elsewhere, waiting degrades to short sleeps.
+	//
+	static void futex_wait(std::atomic<std::uint32_t>* word, std::uint32_t expected, std::chrono::nanoseconds timeout) noexcept {
+#if defined(__linux__)
+		const auto secs = std::chrono::duration_cast<std::chrono::seconds>(timeout);
+		timespec ts{static_cast<time_t>(secs.count()), static_cast<long>((timeout - secs).count())};
+		::syscall(SYS_futex, reinterpret_cast<std::uint32_t*>(word), FUTEX_WAIT, expected, &ts, nullptr, 0);
+#else
+		(void)word; (void)expected;
+		std::this_thread::sleep_for(std::min(timeout, std::chrono::nanoseconds(50'000)));
+#endif
+	}
+
+	static void futex_wake(std::atomic<std::uint32_t>* word) noexcept {
+#if defined(__linux__)
+		::syscall(SYS_futex, reinterpret_cast<std::uint32_t*>(word), FUTEX_WAKE, INT_MAX, nullptr, nullptr, 0);
+#else
+		(void)word;
+#endif
+	}
+
+	unsigned char*	base_ = nullptr;
+	std::size_t		bytes_;
+};
+
+// Forward every event of ev into ring. Destroying the subscription stops it.
+//
+template <typename... Ts>
+[[nodiscard]] typename Event<Ts...>::Subscription shm_export(const std::shared_ptr<Event<Ts...>>& ev,
+		std::shared_ptr<ShmRing<Ts...>> ring) {
+	return ev->subscribe([ring = std::move(ring)](const Ts&... args) noexcept { ring->publish(args...); });
+}
+
+/// ShmImport<Ts...> republishes what arrives on a ShmRing into a local Event,
+/// from a reader thread of its own.
+///
+/// - The thread sleeps on the ring's futex when there is nothing to read,
+///   so an idle import costs nothing. The destructor stops and joins it.
+/// - Events a slow import missed are counted in lost().
+///
+template <typename... Ts>
+class ShmImport {
+public:
+	ShmImport(std::shared_ptr<ShmRing<Ts...>> ring, std::shared_ptr<Event<Ts...>> ev)
+		: reader_(ring->reader()), ev_(std::move(ev)), thread_([this] { run(); }) { }
+
+	~ShmImport() {
+		stop_.store(true, std::memory_order_release);
+		reader_.interrupt();
+		thread_.join();
+	}
+
+	ShmImport(const ShmImport&)				= delete;
+	ShmImport& operator =(const ShmImport&)	= delete;
+
+	std::uint64_t lost() const noexcept { return lost_.load(std::memory_order_relaxed); }
+
+private:
+	static constexpr std::chrono::milliseconds kIdleWait{100};
+
+	void run() {
+		while (!stop_.load(std::memory_order_acquire)) {
+			reader_.poll([&](const Ts&... args) { ev_->publish(args...); });
+			lost_.store(reader_.lost(), std::memory_order_relaxed);
+			reader_.wait(kIdleWait);
+		}
+	}
+
+	typename ShmRing<Ts...>::Reader		reader_;
+	std::shared_ptr<Event<Ts...>>		ev_;
+	std::atomic<bool>					stop_{false};
+	std::atomic<std::uint64_t>			lost_{0};
+	std::thread							thread_;	// Last, started once the rest exists
+};
+
+} // namespace stel
@@ -0,0 +1,32 @@
+#pragma once
+
+#include <atomic>
+#include <thread>
+
+namespace stel {
+
+/// Tiny test-and-test-and-set lock for critical sections of a few
+/// instructions. Satisfies Lockable, so it works with std::lock_guard.
+///
+class SpinLock {
+public:
+	void lock() noexcept {
+		while (flag_.exchange(true, std::memory_order_acquire)) {
+			while (flag_.load(std::memory_order_relaxed)) {
+				std::this_thread::yield();
+			}
+		}
+	}
+
+	bool try_lock() noexcept {
+		return !flag_.load(std::memory_order_relaxed) &&
+			!flag_.exchange(true, std::memory_order_acquire);
+	}
+
+	void unlock() noexcept { flag_.store(false, std::memory_order_release); }
+
+private:
+	std::atomic<bool> flag_{false};
+};
+
+} // namespace stel
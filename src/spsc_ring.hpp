@@ -0,0 +1,95 @@
+#pragma once
+
+#include <atomic>
+#include <bit>
+#include <cstddef>
+#include <memory>
+#include <new>
+#include <utility>
+
+#include "config.hpp"
+
+namespace stel {
+
+/// SpscRing<T> is a bounded single-producer/single-consumer ring buffer.
+///
+/// - head (consumer) and tail (producer) live on their own cache lines, each
+///   next to a cached copy of the other side's index, so in steady state a
+///   push or pop touches no line the other thread writes.
+/// - Capacity is rounded up to a power of two.
+/// - Exactly one thread may push and one may pop at a time; callers with
+///   several producers serialize them (see Mailbox).
+
+template <typename T>
+class SpscRing {
+public:
+	explicit SpscRing(std::size_t capacity)
+		: mask_(std::bit_ceil(capacity < 2 ? std::size_t{2} : capacity) - 1)
+		, cells_(new Cell[mask_ + 1]) { }
+
+	~SpscRing() {
+		const std::size_t tail = tail_.load(std::memory_order_relaxed);
+		for (std::size_t i = head_.load(std::memory_order_relaxed); i != tail; i++) {
+			item(i)->~T();
+		}
+	}
+
+	SpscRing(const SpscRing&)				= delete;
+	SpscRing& operator =(const SpscRing&)	= delete;
+
+	template <typename U>
+	bool try_push(U&& value) {
+		const std::size_t tail = tail_.load(std::memory_order_relaxed);
+		if (tail - cached_head_ > mask_) {
+			cached_head_ = head_.load(std::memory_order_acquire);
+			if (tail - cached_head_ > mask_) {
+				return false; // Full
+			}
+		}
+		::new (static_cast<void*>(cells_[tail & mask_].storage)) T(std::forward<U>(value));
+		tail_.store(tail + 1, std::memory_order_release);
+		return true;
+	}
+
+	bool try_pop(T& out) {
+		const std::size_t head = head_.load(std::memory_order_relaxed);
+		if (head == cached_tail_) {
+			cached_tail_ = tail_.load(std::memory_order_acquire);
+			if (head == cached_tail_) {
+				return false; // Empty
+			}
+		}
+		T* p = item(head);
+		out = std::move(*p);
+		p->~T();
+		head_.store(head + 1, std::memory_order_release);
+		return true;
+	}
+
+	// Exact from either side's own thread, approximate from anywhere else.
+	//
+	std::size_t size() const noexcept {
+		return tail_.load(std::memory_order_acquire) - head_.load(std::memory_order_acquire);
+	}
+
+	bool empty() const noexcept { return size() == 0; }
+	std::size_t capacity() const noexcept { return mask_ + 1; }
+
+private:
+	struct Cell {
+		alignas(T) unsigned char storage[sizeof(T)];
+	};
+
+	T* item(std::size_t i) noexcept {
+		return std::launder(reinterpret_cast<T*>(cells_[i & mask_].storage));
+	}
+
+	const std::size_t								mask_;
+	std::unique_ptr<Cell[]>							cells_;
+	alignas(cache_line_size) std::atomic<std::size_t>	head_{0};
+	std::size_t										cached_tail_ = 0; // Consumer-owned
+	alignas(cache_line_size) std::atomic<std::size_t>	tail_{0};
+	std::size_t										cached_head_ = 0; // Producer-owned
+};
+
+} // namespace stel
@@ -0,0 +1,130 @@
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <string_view>
+#include <tuple>
+#include <type_traits>
+#include <utility>
+
+#include "event.hpp"
+
+namespace stel {
+
+// String literal usable as a template argument: StaticTopic<"cpu.load", ...>.
+//
+template <std::size_t N>
+struct FixedString {
+	constexpr FixedString(const char (&s)[N]) { std::copy_n(s, N, chars); }
+
+	constexpr std::string_view view() const noexcept { return {chars, N - 1}; }
+
+	char chars[N] = {};
+};
+
+// 64-bit FNV-1a, usable in constant expressions.
+//
+constexpr std::uint64_t topic_hash(std::string_view name) noexcept {
+	std::uint64_t h = 14695981039346656037ull;
+	for (char c : name) {
+		h ^= static_cast<unsigned char>(c);
+		h *= 1099511628211ull;
+	}
+	return h;
+}
+
+// Compile-time topic: a name, its hashed ID and its payload signature.
+// Declare topics as aliases or by deriving from it:
+//   struct CpuLoad : StaticTopic<"cpu.load", double> {};
+//
+template <FixedString Name, typename... Ts>
+struct StaticTopic {
+	using event_type = Event<Ts...>;
+
+	static constexpr std::string_view	name	= Name.view();
+	static constexpr std::uint64_t		id		= topic_hash(name);
+};
+
+/// StaticBus<Topics...> is an EventBus whose topics are known at compile time.
+///
+/// - Each topic is a type (see StaticTopic) with its own payload signature.
+/// - Topics resolve to a fixed index at compile time, so publish<T>(...) is
+///   an indexed load of the channel followed by Event::publish: no hashing,
+///   no map lookup, no epoch pin beyond the Event's own.
+/// - Channels are created with the bus and live as long as it does.
+/// - Duplicate topics, or two names hashing to the same ID, do not compile.
+///
+/// Typical use:
+///   struct CpuLoad : StaticTopic<"cpu.load", double> {};
+///   struct MemFree : StaticTopic<"mem.free", std::size_t> {};
+///
+///   StaticBus<CpuLoad, MemFree> bus;
+///   auto sub = bus.subscribe<CpuLoad>([](double v) { ... });
+///   bus.publish<CpuLoad>(0.75);
+///
+template <typename... Topics>
+class StaticBus {
+public:
+	static constexpr std::size_t topic_count = sizeof...(Topics);
+
+	// Compile-time index of Topic.
+	//
+	template <typename Topic>
+	static constexpr std::size_t index_of() noexcept {
+		constexpr std::array<bool, topic_count> same = {std::is_same_v<Topic, Topics>...};
+		constexpr std::size_t i = std::find(same.begin(), same.end(), true) - same.begin();
+		static_assert(i < topic_count, "topic is not declared on this StaticBus");
+		return i;
+	}
+
+	template <typename Topic>
+	using event_type = typename Topic::event_type;
+
+	StaticBus() : channels_(std::make_shared<typename Topics::event_type>()...) { }
+
+	StaticBus(const StaticBus&)				= delete;
+	StaticBus& operator =(const StaticBus&)	= delete;
+
+	template <typename Topic, typename... Args>
+	void publish(Args&&... args) const {
+		std::get<index_of<Topic>()>(channels_)->publish(std::forward<Args>(args)...);
+	}
+
+	template <typename Topic, typename F>
+	[[nodiscard]] typename event_type<Topic>::Subscription subscribe(F&& cb) {
+		return std::get<index_of<Topic>()>(channels_)->subscribe(std::forward<F>(cb));
+	}
+
+	template <typename Topic>
+	std::size_t subscriber_count() const {
+		return std::get<index_of<Topic>()>(channels_)->subscriber_count();
+	}
+
+	// The channel itself, for everything else Event offers (transactions,
+	// mailboxes, error handlers, ...).
+	//
+	template <typename Topic>
+	const std::shared_ptr<event_type<Topic>>& event() const noexcept {
+		return std::get<index_of<Topic>()>(channels_);
+	}
+
+private:
+	static constexpr bool unique_ids() noexcept {
+		constexpr std::array<std::uint64_t, topic_count> ids = {Topics::id...};
+		for (std::size_t i = 0; i < topic_count; i++) {
+			for (std::size_t j = i + 1; j < topic_count; j++) {
+				if (ids[i] == ids[j]) return false;
+			}
+		}
+		return true;
+	}
+
+	static_assert(unique_ids(), "StaticBus topics must have distinct names");
+
+	std::tuple<std::shared_ptr<typename Topics::event_type>...> channels_;
+};
+
+} // namespace stel
@@ -0,0 +1,182 @@
+#pragma once
+
+#include <atomic>
+#include <coroutine>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <stdexcept>
+#include <thread>
+#include <utility>
+
+#include "config.hpp"
+#include "dispatcher.hpp"
+#include "envelope.hpp"
+#include "executor.hpp"
+#include "mailbox.hpp"
+#include "spin_lock.hpp"
+#include "spsc_ring.hpp"
+
+namespace stel {
+
+struct StreamOptions {
+	std::size_t					capacity	= 1024;	// Rounded up to a power of two
+	Backpressure				overflow	= Backpressure::Block;
+	// Where the waiting coroutine is resumed. Null resumes it inline, on the
+	// publishing thread, with no handoff at all.
+	std::shared_ptr<Executor>	executor;
+};
+
+/// StreamInbox<Ts...> queues events for one coroutine instead of a callback.
+///
+/// - offer(...) pushes the shared EnvelopePtr into an SpscRing exactly like
+///   Mailbox (publishers serialized by a spin lock), then resumes the
+///   consumer if it is parked. Nothing is scheduled while it is running.
+/// - next() is an awaitable yielding the next EnvelopePtr, or a null one once
+///   the stream has ended: the Event is gone (the queue is drained first) or
+///   the subscriber was removed (the queue is discarded).
+/// - The consumer parks by publishing its coroutine handle; the publisher
+///   that finds it exchanges it out, so each suspension is resumed once.
+/// - One coroutine at a time may await next(). Overflow is Block or
+///   DropNewest, as for Mailbox.
+///
+/// Typical use (through Event):
+///   auto events = ev->stream();
+///   while (auto e = co_await events.next()) { use(std::get<0>(*e)); }
+
+template <typename... Ts>
+class StreamInbox final : public Inbox<Ts...> {
+public:
+	using Item = typename Inbox<Ts...>::Item;
+
+	class Next {
+	public:
+		bool await_ready() { return inbox_.take(item_); }
+
+		bool await_suspend(std::coroutine_handle<> h) { return inbox_.park(h); }
+
+		Item await_resume() {
+			if (!item_) inbox_.take(item_);
+			return std::move(item_);
+		}
+
+	private:
+		friend class StreamInbox;
+		explicit Next(StreamInbox& inbox) noexcept : inbox_(inbox) { }
+
+		StreamInbox&	inbox_;
+		Item			item_;
+	}; // class Next
+
+	explicit StreamInbox(const StreamOptions& opts)
+		: ring_(opts.capacity)
+		, executor_(opts.executor)
+		, policy_(opts.overflow) {
+		if (policy_ == Backpressure::DropOldest) {
+			throw std::invalid_argument("StreamInbox does not support Backpressure::DropOldest");
+		}
+	}
+
+	StreamInbox(const StreamInbox&)				= delete;
+	StreamInbox& operator =(const StreamInbox&)	= delete;
+
+	[[nodiscard]] Next next() noexcept { return Next{*this}; }
+
+	bool offer(const Item& env) override {
+		if (!open_.load(std::memory_order_acquire)) return false;
+		{
+			std::lock_guard<SpinLock> lk(producer_lock_);
+			while (!ring_.try_push(env)) {
+				if (policy_ == Backpressure::DropNewest) {
+					dropped_.fetch_add(1, std::memory_order_relaxed);
+					return false;
+				}
+				std::this_thread::yield();
+			}
+		}
+		wake();
+		return true;
+	}
+
+	void close() noexcept override {
+		discard_.store(true, std::memory_order_release);
+		open_.store(false, std::memory_order_release);
+		wake();
+	}
+
+	void finish() noexcept override {
+		open_.store(false, std::memory_order_release);
+		wake();
+	}
+
+	// Consumer. Drop a parked coroutine without resuming it, e.g. because
+	// its owner is tearing the stream down.
+	//
+	void detach() noexcept { waiter_.store(nullptr, std::memory_order_release); }
+
+	MailboxStats stats() const noexcept override {
+		return MailboxStats{
+			ring_.size(),
+			delivered_.load(std::memory_order_relaxed),
+			dropped_.load(std::memory_order_relaxed),
+		};
+	}
+
+private:
+	// Consumer. True with out set, or with out null once the stream ended.
+	//
+	bool take(Item& out) {
+		if (!discard_.load(std::memory_order_acquire)) {
+			if (ring_.try_pop(out)) {
+				delivered_.fetch_add(1, std::memory_order_relaxed);
+				return true;
+			}
+			if (open_.load(std::memory_order_acquire)) return false;
+			// Ended: whatever was pushed before finish() is still ours.
+			if (ring_.try_pop(out)) {
+				delivered_.fetch_add(1, std::memory_order_relaxed);
+				return true;
+			}
+		}
+		out.reset();
+		return true;
+	}
+
+	// Consumer. Returns false to resume h right away. The fences pair with
+	// wake(): either we see the push, or the publisher sees waiter_.
+	//
+	bool park(std::coroutine_handle<> h) {
+		waiter_.store(h.address(), std::memory_order_relaxed);
+		std::atomic_thread_fence(std::memory_order_seq_cst);
+		if (!ring_.empty() || !open_.load(std::memory_order_acquire)) {
+			if (waiter_.exchange(nullptr, std::memory_order_acq_rel)) return false;
+		}
+		return true;
+	}
+
+	void wake() noexcept {
+		std::atomic_thread_fence(std::memory_order_seq_cst);
+		if (!waiter_.load(std::memory_order_relaxed)) return;
+		if (void* addr = waiter_.exchange(nullptr, std::memory_order_acq_rel)) {
+			const auto h = std::coroutine_handle<>::from_address(addr);
+			if (executor_) {
+				executor_->execute([h] { h.resume(); });
+			} else {
+				h.resume();
+			}
+		}
+	}
+
+	SpscRing<Item>								ring_;
+	std::shared_ptr<Executor>					executor_;	// Null resumes inline
+	const Backpressure							policy_;
+	std::atomic<bool>							open_{true};
+	std::atomic<bool>							discard_{false};
+	alignas(cache_line_size) SpinLock			producer_lock_;
+	std::atomic<std::uint64_t>					dropped_{0};	// Producer side
+	alignas(cache_line_size) std::atomic<void*>	waiter_{nullptr};	// Parked consumer
+	std::atomic<std::uint64_t>					delivered_{0};	// Consumer side
+};
+
+} // namespace stel
@@ -0,0 +1,199 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <functional>
+#include <memory>
+#include <string>
+#include <string_view>
+#include <type_traits>
+#include <utility>
+
+#include "config.hpp"
+#include "epoch.hpp"
+
+namespace stel {
+
+/// TopicMap<V> is a read-mostly string-keyed hash map with lock-free lookups.
+///
+/// - find(...) walks immutable bucket chains and never blocks. The caller must
+///   hold an EpochGuard for as long as it uses the returned pointer.
+/// - Writers must be serialized externally (EventBus holds a mutex for that).
+///   New nodes are linked at the head of their bucket with a release store,
+///   so a concurrent reader sees either the old or the new chain.
+/// - Growing rebuilds the table with fresh nodes and retires the old table to
+///   the EpochDomain, so in-flight readers keep walking a consistent copy.
+///   V should therefore be cheap to copy (e.g. a std::shared_ptr).
+/// - erase_if(...) unlinks nodes in place and retires them; a reader standing
+///   on an erased node still finds the rest of its chain. The table shrinks
+///   once it is mostly empty.
+/// - Keys are std::string by default, looked up by std::string_view. Other
+///   key types need std::hash and operator==.
+///
+template <typename V, typename K = std::string>
+class TopicMap {
+public:
+	using key_type		= K;
+	using lookup_type	= std::conditional_t<std::is_same_v<K, std::string>, std::string_view, K>;
+
+	TopicMap() : table_(new Table(kInitialBuckets)) { EpochDomain::instance(); }
+
+	~TopicMap() {
+		EpochDomain::instance().retire(table_.load(std::memory_order_relaxed), &Table::destroy);
+	}
+
+	TopicMap(const TopicMap&)				= delete;
+	TopicMap& operator =(const TopicMap&)	= delete;
+
+	// Lookup, requires an EpochGuard held by the caller.
+	//
+	V* find(const lookup_type& key) const noexcept {
+		const std::size_t h = hash(key);
+		const Table* t = table_.load(std::memory_order_acquire);
+		for (Node* n = t->buckets[h & t->mask].load(std::memory_order_acquire); n;
+				n = n->next.load(std::memory_order_acquire)) {
+			if (n->hash == h && n->key == key) {
+				return &n->value;
+			}
+		}
+		return nullptr;
+	}
+
+	// Writer: return the value for key, inserting make() if it is missing.
+	// The reference is valid until the next writer call.
+	//
+	template <typename Make>
+	V& find_or_emplace(const lookup_type& key, Make&& make) {
+		const std::size_t h = hash(key);
+		Table* t = table_.load(std::memory_order_relaxed);
+		for (Node* n = t->buckets[h & t->mask].load(std::memory_order_relaxed); n;
+				n = n->next.load(std::memory_order_relaxed)) {
+			if (n->hash == h && n->key == key) {
+				return n->value;
+			}
+		}
+
+		if (size_ + 1 > t->mask + 1) {
+			t = resize(t, (t->mask + 1) * 2);
+		}
+
+		auto& bucket = t->buckets[h & t->mask];
+		auto* node = new Node(K(key), h, make());
+		node->next.store(bucket.load(std::memory_order_relaxed), std::memory_order_relaxed);
+		bucket.store(node, std::memory_order_release);
+		++size_;
+		return node->value;
+	}
+
+	// Writer: call fn(key, value) for every entry, in no particular order.
+	//
+	template <typename F>
+	void for_each(F&& fn) {
+		Table* t = table_.load(std::memory_order_relaxed);
+		for (std::size_t i = 0; i <= t->mask; i++) {
+			for (Node* n = t->buckets[i].load(std::memory_order_relaxed); n;
+					n = n->next.load(std::memory_order_relaxed)) {
+				fn(static_cast<const lookup_type&>(n->key), n->value);
+			}
+		}
+	}
+
+	// Writer: remove every entry for which pred(key, value) is true and
+	// return how many were removed.
+	//
+	template <typename Pred>
+	std::size_t erase_if(Pred&& pred) {
+		Table* t = table_.load(std::memory_order_relaxed);
+		std::size_t erased = 0;
+		for (std::size_t i = 0; i <= t->mask; i++) {
+			std::atomic<Node*>* link = &t->buckets[i];
+			while (Node* n = link->load(std::memory_order_relaxed)) {
+				if (!pred(static_cast<const lookup_type&>(n->key), n->value)) {
+					link = &n->next;
+					continue;
+				}
+				// n->next is left intact for readers still on n.
+				link->store(n->next.load(std::memory_order_relaxed), std::memory_order_release);
+				EpochDomain::instance().retire(n);
+				++erased;
+			}
+		}
+		size_ -= erased;
+		std::size_t buckets = t->mask + 1;
+		while (buckets > kInitialBuckets && size_ * 4 < buckets) {
+			buckets /= 2;
+		}
+		if (buckets != t->mask + 1) {
+			resize(t, buckets);
+		}
+		return erased;
+	}
+
+	// Writer-side count; readers may observe a slightly stale value.
+	//
+	std::size_t size() const noexcept { return size_; }
+
+private:
+	static constexpr std::size_t kInitialBuckets = 16;
+
+	struct Node {
+		Node(K k, std::size_t h, V v)
+			: key(std::move(k)), hash(h), value(std::move(v)) { }
+
+		const K				key;
+		const std::size_t	hash;
+		V					value;
+		std::atomic<Node*>	next{nullptr};
+	};
+
+	struct Table {
+		explicit Table(std::size_t n)
+			: mask(n - 1), buckets(new std::atomic<Node*>[n]()) { }
+
+		// Table owns its nodes, both are reclaimed together.
+		//
+		static void destroy(void* p) {
+			auto* t = static_cast<Table*>(p);
+			for (std::size_t i = 0; i <= t->mask; i++) {
+				Node* n = t->buckets[i].load(std::memory_order_relaxed);
+				while (n) {
+					delete std::exchange(n, n->next.load(std::memory_order_relaxed));
+				}
+			}
+			delete t;
+		}
+
+		const std::size_t						mask;
+		std::unique_ptr<std::atomic<Node*>[]>	buckets;
+	};
+
+	static std::size_t hash(const lookup_type& key) noexcept {
+		return std::hash<lookup_type>{}(key);
+	}
+
+	// Rebuild with n buckets. Nodes are copied rather than relinked, because
+	// relinking would let a concurrent reader wander into the wrong chain and
+	// miss a key that is present.
+	//
+	Table* resize(Table* old, std::size_t n) {
+		auto next = std::make_unique<Table>(n);
+		for (std::size_t i = 0; i <= old->mask; i++) {
+			for (Node* n = old->buckets[i].load(std::memory_order_relaxed); n;
+					n = n->next.load(std::memory_order_relaxed)) {
+				auto& bucket = next->buckets[n->hash & next->mask];
+				auto* copy = new Node(n->key, n->hash, n->value);
+				copy->next.store(bucket.load(std::memory_order_relaxed), std::memory_order_relaxed);
+				bucket.store(copy, std::memory_order_relaxed);
+			}
+		}
+		Table* t = next.release();
+		table_.store(t, std::memory_order_release);
+		EpochDomain::instance().retire(old, &Table::destroy);
+		return t;
+	}
+
+	std::atomic<Table*>						table_;
+	alignas(cache_line_size) std::size_t	size_ = 0; // Writer-only, kept off the readers' line
+};
+
+} // namespace stel
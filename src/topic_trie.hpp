@@ -0,0 +1,219 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <optional>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+namespace stel {
+
+/// TopicTrie<V> maps hierarchical topic patterns to values.
+///
+/// - Topics are '.'-separated segments, e.g. "cpu.core3.temp".
+/// - In a pattern, a "*" segment matches exactly one segment and a trailing
+///   "#" matches zero or more, so "cpu.*.temp" and "cpu.#" both match the
+///   topic above.
+/// - Literal segments are interned once and children are keyed by the
+///   interned ID; a topic segment that was never interned cannot match a
+///   literal child, so it is rejected with a single hash lookup.
+/// - Not thread-safe: EventBus only touches it with its writer mutex held,
+///   and caches the results per topic so publishers never walk the trie.
+///
+/// Typical use:
+///   TopicTrie<int> trie;
+///   trie.find_or_emplace("cpu.*.temp", [] { return 1; });
+///   trie.match("cpu.core3.temp", [](int& v) { ... });
+///
+template <typename V>
+class TopicTrie {
+public:
+	static constexpr char kSeparator = '.';
+	static constexpr std::string_view kAnyOne = "*";
+	static constexpr std::string_view kAnyTail = "#";
+
+	// True if any segment of topic is a wildcard.
+	//
+	static bool is_pattern(std::string_view topic) noexcept {
+		bool wild = false;
+		for_each_segment(topic, [&](std::string_view seg) {
+			wild = wild || seg == kAnyOne || seg == kAnyTail;
+		});
+		return wild;
+	}
+
+	// Does pattern match the literal topic?
+	//
+	static bool matches(std::string_view pattern, std::string_view topic) {
+		const auto p = split(pattern);
+		const auto t = split(topic);
+		std::size_t i = 0;
+		for (; i < p.size(); i++) {
+			if (p[i] == kAnyTail) return true;
+			if (i == t.size() || (p[i] != kAnyOne && p[i] != t[i])) return false;
+		}
+		return i == t.size();
+	}
+
+	// Return the value for pattern, inserting make() if it is missing.
+	// Throws std::invalid_argument if "#" is not the last segment.
+	//
+	template <typename Make>
+	V& find_or_emplace(std::string_view pattern, Make&& make) {
+		const auto segs = split(pattern);
+		Node* node = &root_;
+		for (std::size_t i = 0; i < segs.size(); i++) {
+			std::unique_ptr<Node>* next;
+			if (segs[i] == kAnyTail) {
+				if (i + 1 != segs.size()) {
+					throw std::invalid_argument("'#' must be the last topic segment");
+				}
+				next = &node->any_tail;
+			} else if (segs[i] == kAnyOne) {
+				next = &node->any_one;
+			} else {
+				next = &node->children[intern(segs[i])];
+			}
+			if (!*next) *next = std::make_unique<Node>();
+			node = next->get();
+		}
+		if (!node->value) {
+			node->value.emplace(make());
+			++size_;
+		}
+		return *node->value;
+	}
+
+	// Exact pattern lookup, nullptr if pattern was never added.
+	//
+	V* find(std::string_view pattern) {
+		Node* node = &root_;
+		for_each_segment(pattern, [&](std::string_view seg) {
+			if (!node) return;
+			if (seg == kAnyTail) {
+				node = node->any_tail.get();
+			} else if (seg == kAnyOne) {
+				node = node->any_one.get();
+			} else {
+				auto id = segments_.find(seg);
+				auto it = id == segments_.end() ? node->children.end() : node->children.find(id->second);
+				node = it == node->children.end() ? nullptr : it->second.get();
+			}
+		});
+		return node && node->value ? &*node->value : nullptr;
+	}
+
+	// Call visit(V&) for the value of every pattern matching topic.
+	//
+	template <typename F>
+	void match(std::string_view topic, F&& visit) {
+		const auto segs = split(topic);
+		std::vector<std::uint32_t> ids;
+		ids.reserve(segs.size());
+		for (std::string_view seg : segs) {
+			auto it = segments_.find(seg);
+			ids.push_back(it == segments_.end() ? kUnknown : it->second);
+		}
+		walk(root_, ids, 0, visit);
+	}
+
+	// Call fn(pattern, V&) for every stored pattern, in no particular order.
+	//
+	template <typename F>
+	void for_each(F&& fn) {
+		std::vector<std::string_view> names(segments_.size());
+		for (const auto& [seg, id] : segments_) {
+			names[id] = seg;
+		}
+		std::string path;
+		visit_all(root_, names, path, fn);
+	}
+
+	std::size_t size() const noexcept { return size_; }
+
+private:
+	static constexpr std::uint32_t kUnknown = UINT32_MAX;
+
+	struct Node {
+		std::unordered_map<std::uint32_t, std::unique_ptr<Node>>	children;
+		std::unique_ptr<Node>										any_one;
+		std::unique_ptr<Node>										any_tail;	// Leaf
+		std::optional<V>											value;
+	};
+
+	struct SegmentHash {
+		using is_transparent = void;
+		std::size_t operator ()(std::string_view s) const noexcept {
+			return std::hash<std::string_view>{}(s);
+		}
+	};
+
+	template <typename F>
+	static void for_each_segment(std::string_view topic, F&& fn) {
+		for (std::size_t pos = 0;;) {
+			const std::size_t end = topic.find(kSeparator, pos);
+			fn(topic.substr(pos, end - pos));
+			if (end == std::string_view::npos) return;
+			pos = end + 1;
+		}
+	}
+
+	static std::vector<std::string_view> split(std::string_view topic) {
+		std::vector<std::string_view> segs;
+		for_each_segment(topic, [&](std::string_view seg) { segs.push_back(seg); });
+		return segs;
+	}
+
+	std::uint32_t intern(std::string_view seg) {
+		auto it = segments_.find(seg);
+		if (it != segments_.end()) return it->second;
+		const auto id = static_cast<std::uint32_t>(segments_.size());
+		segments_.emplace(std::string(seg), id);
+		return id;
+	}
+
+	template <typename F>
+	static void walk(Node& node, const std::vector<std::uint32_t>& ids, std::size_t i, F& visit) {
+		if (node.any_tail && node.any_tail->value) visit(*node.any_tail->value);
+		if (i == ids.size()) {
+			if (node.value) visit(*node.value);
+			return;
+		}
+		if (node.any_one) walk(*node.any_one, ids, i + 1, visit);
+		if (ids[i] == kUnknown) return;
+		if (auto it = node.children.find(ids[i]); it != node.children.end()) {
+			walk(*it->second, ids, i + 1, visit);
+		}
+	}
+
+	template <typename F>
+	static void visit_all(Node& node, const std::vector<std::string_view>& names, std::string& path, F& fn) {
+		if (node.value) fn(std::string_view(path), *node.value);
+		auto descend = [&](Node& child, std::string_view seg) {
+			const std::size_t len = path.size();
+			if (len != 0) path += kSeparator;
+			path += seg;
+			visit_all(child, names, path, fn);
+			path.resize(len);
+		};
+		for (auto& [id, child] : node.children) {
+			descend(*child, names[id]);
+		}
+		if (node.any_one) descend(*node.any_one, kAnyOne);
+		if (node.any_tail) descend(*node.any_tail, kAnyTail);
+	}
+
+	using Segments = std::unordered_map<std::string, std::uint32_t, SegmentHash, std::equal_to<>>;
+
+	Node			root_;
+	Segments		segments_;	// Interned literal segments
+	std::size_t		size_ = 0;
+};
+
+} // namespace stel
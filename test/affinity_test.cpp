@@ -0,0 +1,82 @@
+#include <gtest/gtest.h>
+
+#include <atomic>
+#include <filesystem>
+#include <fstream>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <unistd.h>
+
+#include "executor.hpp"
+
+using namespace stel;
+
+TEST(AffinityTest, ParsesCpuLists) {
+    EXPECT_EQ(parse_cpu_list("0-3,8,10-11\n"), (std::vector<int>{0, 1, 2, 3, 8, 10, 11}));
+    EXPECT_EQ(parse_cpu_list("5,1,5"), (std::vector<int>{1, 5}));
+    EXPECT_EQ(parse_cpu_list("x,2,4-3,6-7y"), (std::vector<int>{2}));
+    EXPECT_TRUE(parse_cpu_list("").empty());
+}
+
+TEST(AffinityTest, TopologyFromSysfsKeepsAllowedCpus) {
+    namespace fs = std::filesystem;
+    const fs::path root = fs::temp_directory_path() / ("stel-topo-" + std::to_string(::getpid()));
+    fs::create_directories(root / "node0");
+    fs::create_directories(root / "node2");
+    fs::create_directories(root / "possible");
+    std::ofstream(root / "node0" / "cpulist") << "0-3\n";
+    std::ofstream(root / "node2" / "cpulist") << "4-7\n";
+
+    const CpuTopology topo = CpuTopology::from_sysfs(root.string(), {1, 2, 5, 6, 7});
+    fs::remove_all(root);
+
+    ASSERT_EQ(topo.nodes().size(), 2u);
+    EXPECT_EQ(topo.nodes()[0].id, 0);
+    EXPECT_EQ(topo.nodes()[0].cpus, (std::vector<int>{1, 2}));
+    EXPECT_EQ(topo.nodes()[1].id, 2);
+    EXPECT_EQ(topo.nodes()[1].cpus, (std::vector<int>{5, 6, 7}));
+    EXPECT_EQ(topo.node_of(6), 1u);
+    EXPECT_EQ(topo.node_of(1), 0u);
+    EXPECT_EQ(topo.node_of(100), 0u);
+}
+
+TEST(AffinityTest, MissingSysfsIsOneNode) {
+    const CpuTopology topo = CpuTopology::from_sysfs("/nonexistent/stel", {0, 1});
+    ASSERT_EQ(topo.nodes().size(), 1u);
+    EXPECT_EQ(topo.nodes()[0].cpus, (std::vector<int>{0, 1}));
+}
+
+TEST(AffinityTest, DispatcherWorkersArePinned) {
+    const std::vector<int> allowed = CpuTopology::allowed_cpus();
+    const int cpu = allowed.back();
+    std::atomic<int> ran_on{-2};
+    {
+        AsyncOptions opts;
+        opts.cpus = {cpu};
+        AsyncDispatcher<int> d(opts, [&](int&) { ran_on = current_cpu(); });
+        d.post(1);
+        d.flush();
+    }
+    EXPECT_EQ(ran_on.load(), cpu);
+}
+
+TEST(AffinityTest, NumaExecutorRunsOnEveryNode) {
+    NumaExecutor numa(NumaOptions{1, 64});
+    ASSERT_GE(numa.node_count(), 1u);
+    std::atomic<int> ran{0};
+    for (int i = 0; i < 10; i++) {
+        numa.execute([&] { ran++; });
+    }
+    std::vector<std::atomic<int>> node_cpu(numa.node_count());
+    for (std::size_t n = 0; n < numa.node_count(); n++) {
+        node_cpu[n] = -1;
+        numa.node(n)->execute([&, n] { node_cpu[n] = current_cpu(); });
+    }
+    numa.flush();
+    EXPECT_EQ(ran.load(), 10);
+    for (std::size_t n = 0; n < numa.node_count(); n++) {
+        EXPECT_EQ(numa.topology().node_of(node_cpu[n].load()), n);
+    }
+}
@@ -0,0 +1,144 @@
+#include <gtest/gtest.h>
+
+#include <memory>
+#include <stdexcept>
+#include <tuple>
+#include <type_traits>
+#include <vector>
+
+#include "basic_event.hpp"
+
+using namespace stel;
+
+static_assert(std::is_same_v<BasicEvent<MultiThreaded, int>, Event<int>>);
+static_assert(std::is_same_v<BasicEvent<SingleThreaded, int>, LocalEvent<int>>);
+
+// The same call sites, instantiated for both policies.
+template <typename Policy>
+class BasicEventTest : public ::testing::Test { };
+
+// Generic code as documented in basic_event.hpp: the policy is named by the caller.
+template <typename Policy>
+auto wire(BasicEvent<Policy, int>& ev, int& sum) {
+    return ev.subscribe([&sum](int v) { sum += v; });
+}
+
+using Policies = ::testing::Types<MultiThreaded, SingleThreaded>;
+TYPED_TEST_SUITE(BasicEventTest, Policies);
+
+TYPED_TEST(BasicEventTest, PublishesInPriorityOrder) {
+    auto ev = std::make_shared<BasicEvent<TypeParam, int>>();
+    std::vector<int> order;
+    auto a = ev->subscribe([&](int v) { order.push_back(v * 10 + 1); });
+    auto b = ev->subscribe([&](int v) { order.push_back(v * 10 + 2); }, 5);
+    auto c = ev->subscribe([&](int v) { order.push_back(v * 10 + 3); });
+    ev->publish(1);
+    EXPECT_EQ(order, (std::vector<int>{12, 11, 13}));
+    EXPECT_EQ(ev->subscriber_count(), 3u);
+}
+
+TYPED_TEST(BasicEventTest, TokensUnsubscribe) {
+    auto ev = std::make_shared<BasicEvent<TypeParam, int>>();
+    int calls = 0;
+    {
+        auto sub = ev->subscribe([&](int) { calls++; });
+        ev->publish(0);
+    }
+    ev->publish(0);
+    EXPECT_EQ(calls, 1);
+
+    auto sub = ev->subscribe([&](int) { calls++; });
+    EXPECT_TRUE(ev->unsubscribe(sub.id()));
+    EXPECT_FALSE(sub.unsubscribe());
+    EXPECT_EQ(ev->subscriber_count(), 0u);
+}
+
+TYPED_TEST(BasicEventTest, TokensOutliveTheEvent) {
+    auto ev = std::make_shared<BasicEvent<TypeParam, int>>();
+    auto sub = ev->subscribe([](int) { });
+    ev.reset();
+    EXPECT_FALSE(sub.unsubscribe());
+}
+
+TYPED_TEST(BasicEventTest, ErrorsAreRoutedToHandler) {
+    auto ev = std::make_shared<BasicEvent<TypeParam, int>>();
+    std::size_t failed = 0;
+    ev->set_error_handler([&](std::size_t id, std::exception_ptr) { failed = id; });
+    auto bad = ev->subscribe([](int) { throw std::runtime_error("boom"); });
+    int calls = 0;
+    auto good = ev->subscribe([&](int) { calls++; });
+    ev->publish(1);
+    EXPECT_EQ(failed, bad.id());
+    EXPECT_EQ(ev->failure_count(), 1u);
+    EXPECT_EQ(calls, 1);
+}
+
+TYPED_TEST(BasicEventTest, GenericCodeNamesThePolicy) {
+    auto ev = std::make_shared<BasicEvent<TypeParam, int>>();
+    int sum = 0;
+    auto sub = wire<TypeParam>(*ev, sum);
+    ev->publish(3);
+    EXPECT_EQ(sum, 3);
+}
+
+TYPED_TEST(BasicEventTest, PublishBatchDeliversEveryEvent) {
+    auto ev = std::make_shared<BasicEvent<TypeParam, int, int>>();
+    int sum = 0;
+    auto sub = ev->subscribe([&](int a, int b) { sum += a * b; });
+    const std::vector<std::tuple<int, int>> events{{1, 2}, {3, 4}};
+    ev->publish_batch(events);
+    EXPECT_EQ(sum, 14);
+}
+
+TEST(LocalEventTest, SubscribeDuringPublishSeesTheNextEvent) {
+    LocalEvent<int> ev;
+    std::vector<int> late_seen;
+    std::vector<LocalEvent<int>::Subscription> late;
+    auto sub = ev.subscribe([&](int v) {
+        if (late.empty()) late.push_back(ev.subscribe([&](int w) { late_seen.push_back(w); }));
+        (void)v;
+    });
+    ev.publish(1);
+    EXPECT_TRUE(late_seen.empty());
+    EXPECT_EQ(ev.subscriber_count(), 2u);
+    ev.publish(2);
+    EXPECT_EQ(late_seen, (std::vector<int>{2}));
+}
+
+TEST(LocalEventTest, UnsubscribeDuringPublishTakesEffectAtOnce) {
+    LocalEvent<int> ev;
+    int second = 0;
+    LocalEvent<int>::Subscription b;
+    auto a = ev.subscribe([&](int) { b.unsubscribe(); });
+    b = ev.subscribe([&](int) { second++; });
+    ev.publish(1);
+    ev.publish(2);
+    EXPECT_EQ(second, 0);
+    EXPECT_EQ(ev.subscriber_count(), 1u);
+}
+
+TEST(LocalEventTest, SubscriberMayDestroyTheEvent) {
+    auto ev = std::make_unique<LocalEvent<int>>();
+    int after = 0;
+    auto a = ev->subscribe([&](int) { ev.reset(); });
+    auto b = ev->subscribe([&](int) { after++; });
+    ev->publish(1);
+    EXPECT_EQ(ev, nullptr);
+    EXPECT_EQ(after, 1);
+    EXPECT_FALSE(b.unsubscribe());
+}
+
+TEST(LocalEventTest, NestedPublishAndClear) {
+    LocalEvent<int> ev;
+    std::vector<int> seen;
+    auto a = ev.subscribe([&](int v) {
+        seen.push_back(v);
+        if (v == 1) ev.publish(2);
+        if (v == 2) ev.clear();
+    });
+    auto b = ev.subscribe([&](int v) { seen.push_back(-v); });
+    ev.publish(1);
+    EXPECT_EQ(seen, (std::vector<int>{1, 2}));
+    EXPECT_EQ(ev.subscriber_count(), 0u);
+    EXPECT_FALSE(a.unsubscribe());
+}
@@ -0,0 +1,80 @@
+#include <gtest/gtest.h>
+
+#include <atomic>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#include "dispatcher.hpp"
+
+using namespace stel;
+
+namespace {
+
+// Handler that blocks on the first item until released, so the queue
+// behind it can be filled deterministically.
+struct Gate {
+    std::atomic<bool> entered{false};
+    std::atomic<bool> open{false};
+    std::mutex m;
+    std::vector<int> seen;
+
+    void operator()(int& v) {
+        entered.store(true);
+        while (!open.load()) std::this_thread::yield();
+        std::lock_guard<std::mutex> lk(m);
+        seen.push_back(v);
+    }
+};
+
+std::vector<int> run_policy(Backpressure policy) {
+    Gate gate;
+    {
+        AsyncDispatcher<int> d({1, 2, policy}, [&gate](int& v) { gate(v); });
+        d.post(1);
+        while (!gate.entered.load()) std::this_thread::yield();
+        d.post(2);
+        d.post(3);
+        if (policy != Backpressure::Block) {
+            d.post(4);
+            EXPECT_EQ(d.dropped(), 1u);
+        }
+        gate.open.store(true);
+        d.flush();
+    }
+    return gate.seen;
+}
+
+} // namespace
+
+TEST(DispatcherTest, DeliversEverythingWithBlockPolicy) {
+    std::atomic<int> sum{0};
+    {
+        AsyncDispatcher<int> d({3, 16, Backpressure::Block}, [&](int& v) { sum.fetch_add(v); });
+        for (int i = 1; i <= 1000; i++) {
+            d.post(i);
+        }
+        d.flush();
+        EXPECT_EQ(sum.load(), 1000 * 1001 / 2);
+        EXPECT_EQ(d.dropped(), 0u);
+    }
+}
+
+TEST(DispatcherTest, DropOldest) {
+    EXPECT_EQ(run_policy(Backpressure::DropOldest), (std::vector<int>{1, 3, 4}));
+}
+
+TEST(DispatcherTest, DropNewest) {
+    EXPECT_EQ(run_policy(Backpressure::DropNewest), (std::vector<int>{1, 2, 3}));
+}
+
+TEST(DispatcherTest, DestructorDrainsQueue) {
+    std::atomic<int> handled{0};
+    {
+        AsyncDispatcher<int> d({2, 256, Backpressure::Block}, [&](int&) { handled.fetch_add(1); });
+        for (int i = 0; i < 200; i++) {
+            d.post(i);
+        }
+    }
+    EXPECT_EQ(handled.load(), 200);
+}
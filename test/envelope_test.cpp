@@ -0,0 +1,92 @@
+#include <gtest/gtest.h>
+
+#include <atomic>
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "envelope.hpp"
+#include "event.hpp"
+
+using namespace stel;
+
+TEST(EnvelopeTest, SharedUntilLastReference) {
+    auto pool = EnvelopePool<std::string, int>::create();
+    auto a = pool->make(std::string("hello"), 7);
+    EXPECT_EQ(a.use_count(), 1u);
+    {
+        auto b = a;
+        EXPECT_EQ(a.use_count(), 2u);
+        EXPECT_EQ(&*a, &*b);
+        EXPECT_EQ(std::get<0>(*b), "hello");
+        EXPECT_EQ(std::get<1>(*b), 7);
+    }
+    EXPECT_EQ(a.use_count(), 1u);
+    EXPECT_EQ(pool->cached(), 0u);
+    a.reset();
+    EXPECT_FALSE(a);
+    EXPECT_EQ(pool->cached(), 1u);
+}
+
+TEST(EnvelopeTest, RecyclesEnvelopes) {
+    auto pool = EnvelopePool<int>::create();
+    const void* first = &*pool->make(1);
+    auto again = pool->make(2);
+    EXPECT_EQ(&*again, first);
+    EXPECT_EQ(std::get<0>(*again), 2);
+}
+
+TEST(EnvelopeTest, RespectsCacheLimit) {
+    auto pool = EnvelopePool<int>::create(2);
+    std::vector<EnvelopePtr<int>> live;
+    for (int i = 0; i < 5; i++) live.push_back(pool->make(i));
+    live.clear();
+    EXPECT_EQ(pool->cached(), 2u);
+}
+
+TEST(EnvelopeTest, OutlivesPoolOwner) {
+    EnvelopePtr<std::string> env;
+    {
+        auto pool = EnvelopePool<std::string>::create();
+        env = pool->make("kept");
+    }
+    EXPECT_EQ(std::get<0>(*env), "kept");
+    env.reset();
+}
+
+TEST(EnvelopeTest, MovesFromRvalues) {
+    auto pool = EnvelopePool<std::string>::create();
+    std::string big(1000, 'x');
+    auto env = pool->make(std::move(big));
+    EXPECT_TRUE(big.empty());
+    EXPECT_EQ(std::get<0>(*env).size(), 1000u);
+}
+
+TEST(EnvelopeTest, EventSharesPayloadAcrossMailboxes) {
+    auto event = std::make_shared<Event<std::string>>();
+    auto exec = std::make_shared<InlineExecutor>();
+    std::vector<const std::string*> seen(2, nullptr);
+    auto s1 = event->subscribe([&](const std::string& s) { seen[0] = &s; },
+            MailboxOptions{8, Backpressure::Block, exec});
+    auto s2 = event->subscribe([&](const std::string& s) { seen[1] = &s; },
+            MailboxOptions{8, Backpressure::Block, exec});
+    std::string payload(256, 'p');
+    event->publish(std::move(payload));
+    EXPECT_TRUE(payload.empty());
+    ASSERT_NE(seen[0], nullptr);
+    EXPECT_EQ(seen[0], seen[1]);
+}
+
+TEST(EnvelopeTest, AsyncEventMovesPayload) {
+    auto event = std::make_shared<Event<std::string>>(AsyncOptions{1, 16, Backpressure::Block});
+    std::atomic<std::size_t> total{0};
+    auto sub = event->subscribe([&](const std::string& s) { total += s.size(); });
+    for (int i = 0; i < 100; i++) {
+        std::string s(10, 'a');
+        event->publish(std::move(s));
+        EXPECT_TRUE(s.empty());
+    }
+    event->flush();
+    EXPECT_EQ(total.load(), 1000u);
+}
@@ -0,0 +1,75 @@
+#include <gtest/gtest.h>
+
+#include <atomic>
+#include <thread>
+
+#include "epoch.hpp"
+
+using namespace stel;
+
+namespace {
+
+struct Tracked {
+    explicit Tracked(std::atomic<int>& c) : count(c) { }
+    ~Tracked() { count.fetch_add(1); }
+    std::atomic<int>& count;
+};
+
+} // namespace
+
+TEST(EpochTest, RetireWithoutReadersFreesImmediately) {
+    std::atomic<int> freed{0};
+    EpochDomain::instance().retire(new Tracked(freed));
+    EXPECT_EQ(freed.load(), 1);
+}
+
+TEST(EpochTest, PinnedReaderDelaysReclamation) {
+    std::atomic<int> freed{0};
+    {
+        EpochGuard g;
+        EpochDomain::instance().retire(new Tracked(freed));
+        EpochDomain::instance().collect();
+        EXPECT_EQ(freed.load(), 0);
+    }
+    EpochDomain::instance().collect();
+    EXPECT_EQ(freed.load(), 1);
+}
+
+TEST(EpochTest, ReaderOnOtherThreadDelaysReclamation) {
+    std::atomic<int> freed{0};
+    std::atomic<bool> pinned{false};
+    std::atomic<bool> release{false};
+
+    std::thread reader([&] {
+        EpochGuard g;
+        pinned.store(true);
+        while (!release.load()) {
+            std::this_thread::yield();
+        }
+    });
+    while (!pinned.load()) {
+        std::this_thread::yield();
+    }
+
+    EpochDomain::instance().retire(new Tracked(freed));
+    EXPECT_EQ(freed.load(), 0);
+
+    release.store(true);
+    reader.join();
+    EpochDomain::instance().collect();
+    EXPECT_EQ(freed.load(), 1);
+}
+
+TEST(EpochTest, GuardsNest) {
+    std::atomic<int> freed{0};
+    {
+        EpochGuard outer;
+        {
+            EpochGuard inner;
+        }
+        EpochDomain::instance().retire(new Tracked(freed));
+        EXPECT_EQ(freed.load(), 0);
+    }
+    EpochDomain::instance().collect();
+    EXPECT_EQ(freed.load(), 1);
+}
@@ -0,0 +1,225 @@
+#include <gtest/gtest.h>
+
+#include <atomic>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "event.hpp"
+
+using namespace stel;
+
+TEST(EventBusTest, RoutesByTopic) {
+    EventBus<int> bus;
+    int cpu = 0, gpu = 0;
+    auto s1 = bus.subscribe("cpu", [&](int v) { cpu += v; });
+    auto s2 = bus.subscribe("gpu", [&](int v) { gpu += v; });
+
+    bus.publish("cpu", 1);
+    bus.publish("gpu", 10);
+    bus.publish("nope", 100);
+    EXPECT_EQ(cpu, 1);
+    EXPECT_EQ(gpu, 10);
+    EXPECT_EQ(bus.subsriber_count("cpu"), 1u);
+    EXPECT_EQ(bus.subsriber_count("nope"), 0u);
+}
+
+TEST(EventBusTest, PublishWhileTopicsAreCreated) {
+    EventBus<int> bus;
+    std::atomic<long> hits{0};
+    auto s = bus.subscribe("hot", [&](int) { hits.fetch_add(1, std::memory_order_relaxed); });
+
+    std::vector<EventBus<int>::EventType::Subscription> subs;
+    std::thread creator([&] {
+        for (int i = 0; i < 5000; i++) {
+            subs.push_back(bus.subscribe("t" + std::to_string(i), [](int) { }));
+        }
+    });
+    std::vector<std::thread> publishers;
+    for (int t = 0; t < 3; t++) {
+        publishers.emplace_back([&] {
+            for (int i = 0; i < 3000; i++) {
+                bus.publish("hot", i);
+            }
+        });
+    }
+    creator.join();
+    for (auto& t : publishers) {
+        t.join();
+    }
+    EXPECT_EQ(hits.load(), 3 * 3000);
+    EXPECT_EQ(bus.subsriber_count("t4999"), 1u);
+}
+
+TEST(EventBusTest, TopicHandleSharesChannel) {
+    EventBus<int> bus;
+    int calls = 0;
+    auto s = bus.subscribe("cpu", [&](int) { calls++; });
+
+    auto cpu = bus.topic("cpu");
+    ASSERT_TRUE(cpu);
+    EXPECT_EQ(cpu.subscriber_count(), 1u);
+    cpu.publish(1);
+    bus.publish(std::string_view("cpu"), 2);
+    EXPECT_EQ(calls, 2);
+
+    int late = 0;
+    auto gpu = bus.topic("gpu");
+    auto s2 = bus.subscribe("gpu", [&](int) { late++; });
+    gpu.publish(1);
+    EXPECT_EQ(late, 1);
+}
+
+TEST(EventBusTest, TransactionAcrossTopics) {
+    EventBus<int> bus;
+    int cpu = 0, gpu = 0;
+    auto old = bus.subscribe("cpu", [&](int) { cpu += 100; });
+
+    auto tx = bus.transaction();
+    tx.subscribe("cpu", [&](int v) { cpu += v; });
+    tx.subscribe("gpu", [&](int v) { gpu += v; });
+    tx.subscribe("cpu", [&](int v) { cpu += v; });
+    tx.unsubscribe("cpu", std::move(old));
+    auto subs = tx.commit();
+    ASSERT_EQ(subs.size(), 3u);
+
+    bus.publish("cpu", 1);
+    bus.publish("gpu", 1);
+    EXPECT_EQ(cpu, 2);
+    EXPECT_EQ(gpu, 1);
+
+    subs[1].unsubscribe();
+    EXPECT_EQ(bus.subsriber_count("gpu"), 0u);
+    EXPECT_EQ(bus.subsriber_count("cpu"), 2u);
+}
+
+TEST(EventBusTest, WildcardSubscriptions) {
+    EventBus<int> bus;
+    auto existing = bus.topic("cpu.core1.temp");
+    int one = 0, tail = 0, exact = 0;
+    auto s1 = bus.subscribe("cpu.*.temp", [&](int v) { one += v; });
+    auto s2 = bus.subscribe("cpu.#", [&](int v) { tail += v; });
+    auto s3 = existing.subscribe([&](int v) { exact += v; });
+
+    existing.publish(1);                // Channel created before the patterns
+    bus.publish("cpu.core2.temp", 10);  // Only reachable through patterns
+    bus.publish("cpu.core2.load", 100);
+    bus.publish("mem.free", 1000);
+    EXPECT_EQ(exact, 1);
+    EXPECT_EQ(one, 11);
+    EXPECT_EQ(tail, 111);
+    EXPECT_EQ(bus.subsriber_count("cpu.#"), 1u);
+
+    s2.unsubscribe();
+    bus.publish("cpu.core2.temp", 10);
+    EXPECT_EQ(one, 21);
+    EXPECT_EQ(tail, 111);
+    EXPECT_THROW((void)bus.topic("cpu.*"), std::invalid_argument);
+}
+
+TEST(EventBusTest, UnmatchedPublishCreatesNoChannel) {
+    EventBus<int> bus;
+    int hits = 0;
+    auto sub = bus.subscribe("cpu.*", [&](int v) { hits += v; });
+    bus.publish("mem.free", 1);
+    bus.publish("cpu.core0.temp", 1);
+    EXPECT_EQ(bus.channel_count(), 0u);
+    bus.publish("cpu.load", 2);
+    EXPECT_EQ(bus.channel_count(), 1u);
+    EXPECT_EQ(hits, 2);
+}
+
+TEST(EventBusTest, NewPatternsSeeTopicsThatMissedBefore) {
+    EventBus<int> bus;
+    int hits = 0;
+    auto cpu = bus.subscribe("cpu.*", [&](int v) { hits += v; });
+    bus.publish("mem.free", 1);
+    bus.publish("mem.free", 1);
+    EXPECT_EQ(hits, 0);
+    auto mem = bus.subscribe("mem.#", [&](int v) { hits += v; });
+    bus.publish("mem.free", 2);
+    EXPECT_EQ(hits, 2);
+    EXPECT_EQ(bus.channel_count(), 1u);
+}
+
+TEST(EventBusTest, TransactionWithPatterns) {
+    EventBus<int> bus;
+    int hits = 0;
+    auto tx = bus.transaction();
+    tx.subscribe("a.*", [&](int) { hits++; });
+    tx.subscribe("a.b", [&](int) { hits++; });
+    auto subs = tx.commit();
+    bus.publish("a.b", 0);
+    EXPECT_EQ(hits, 2);
+
+    auto rm = bus.transaction();
+    rm.unsubscribe("a.*", std::move(subs[0]));
+    EXPECT_TRUE(rm.commit().empty());
+    bus.publish("a.b", 0);
+    EXPECT_EQ(hits, 3);
+}
+
+TEST(EventBusTest, SubscribeForwardsPriority) {
+    EventBus<int> bus;
+    std::vector<int> order;
+    auto low = bus.subscribe("t", [&](int) { order.push_back(1); });
+    auto high = bus.subscribe("t", [&](int) { order.push_back(2); }, 10);
+    bus.publish("t", 0);
+    EXPECT_EQ(order, (std::vector<int>{2, 1}));
+}
+
+TEST(EventBusTest, IdleChannelsAreReclaimedAfterTwoSweeps) {
+    EventBus<int> bus;
+    auto kept = bus.subscribe("kept", [](int) { });
+    auto handle = bus.topic("handle");
+    {
+        auto gone = bus.subscribe("session.1", [](int) { });
+    }
+    EXPECT_EQ(bus.channel_count(), 3u);
+
+    EXPECT_EQ(bus.collect_idle(), 0u);	// Marks session.1
+    EXPECT_EQ(bus.collect_idle(), 1u);
+    EXPECT_EQ(bus.channel_count(), 2u);
+    EXPECT_EQ(bus.subsriber_count("kept"), 1u);
+
+    // Touching a marked channel spares it from the next sweep.
+    auto flap = bus.subscribe("flap", [](int) { });
+    flap.unsubscribe();
+    EXPECT_EQ(bus.collect_idle(), 0u);
+    bus.subscribe("flap", [](int) { }).unsubscribe();
+    EXPECT_EQ(bus.collect_idle(), 0u);
+    EXPECT_EQ(bus.collect_idle(), 1u);
+
+    // A reclaimed topic comes back on the next subscribe.
+    int got = 0;
+    auto again = bus.subscribe("session.1", [&](int v) { got = v; });
+    bus.publish("session.1", 5);
+    EXPECT_EQ(got, 5);
+}
+
+TEST(EventBusTest, ChannelCountTracksLiveTopics) {
+    EventBus<int> bus;
+    for (int i = 0; i < 10000; i++) {
+        auto s = bus.subscribe("session." + std::to_string(i), [](int) { });
+    }
+    EXPECT_LT(bus.channel_count(), 1000u);
+}
+
+TEST(EventBusTest, PublishWhileChannelsAreReclaimed) {
+    EventBus<int> bus;
+    std::atomic<bool> stop{false};
+    std::thread publisher([&] {
+        for (int i = 0; !stop.load(); i++) {
+            bus.publish("session." + std::to_string(i % 500), i);
+            if (i % 64 == 0) std::this_thread::yield();
+        }
+    });
+    for (int i = 0; i < 2000; i++) {
+        auto s = bus.subscribe("session." + std::to_string(i % 500), [](int) { });
+        if (i % 100 == 0) bus.collect_idle();
+    }
+    stop = true;
+    publisher.join();
+    EXPECT_LT(bus.channel_count(), 500u);
+}
@@ -0,0 +1,101 @@
+#include <gtest/gtest.h>
+
+#include <chrono>
+#include <cstdint>
+#include <stdexcept>
+#include <string_view>
+#include <thread>
+#include <vector>
+
+#include "event.hpp"
+
+using namespace stel;
+
+// Instrumentation is a build option; CMakeLists.txt turns it on for this test.
+static_assert(event_stats_enabled, "event_stats_test must be built with STEL_EVENT_STATS=1");
+
+TEST(EventStatsTest, ShardedCounterSumsAllThreads) {
+    ShardedCounter counter;
+    std::vector<std::thread> threads;
+    for (int t = 0; t < 4; t++) {
+        threads.emplace_back([&] {
+            for (int i = 0; i < 1000; i++) counter.add();
+        });
+    }
+    for (auto& t : threads) t.join();
+    EXPECT_EQ(counter.load(), 4000u);
+}
+
+TEST(EventStatsTest, HistogramQuantilesStayWithinBucketError) {
+    LatencyHistogram h;
+    EXPECT_EQ(h.summary().count, 0u);
+    for (std::uint64_t ns = 1; ns <= 1000; ns++) h.record(ns);
+    const LatencySummary s = h.summary();
+    EXPECT_EQ(s.count, 1000u);
+    EXPECT_EQ(s.max, 1000u);
+    EXPECT_GE(s.p50, 500u);
+    EXPECT_LE(s.p50, 500u + 500u / LatencyHistogram::kSubBuckets);
+    EXPECT_GE(s.p99, 990u);
+    EXPECT_LE(s.p99, 1000u);
+
+    h.record(std::uint64_t{1} << 50);	// Past the last bucket, still counted
+    EXPECT_EQ(h.summary().max, std::uint64_t{1} << 50);
+}
+
+TEST(EventStatsTest, EventCountsPublishesDeliveriesAndLatency) {
+    auto ev = std::make_shared<Event<int>>();
+    auto fast = ev->subscribe([](int) noexcept { });
+    auto slow = ev->subscribe([](int v) {
+        if (v < 0) throw std::runtime_error("negative");
+        std::this_thread::sleep_for(std::chrono::microseconds(200));
+    });
+    for (int i = 0; i < 10; i++) ev->publish(i);
+    ev->publish(-1);
+
+    const EventStats s = ev->stats();
+    EXPECT_EQ(s.publishes, 11u);
+    EXPECT_EQ(s.deliveries, 22u);
+    EXPECT_EQ(s.failures, 1u);
+    EXPECT_EQ(s.rebuilds, 2u);
+    ASSERT_EQ(s.subscribers.size(), 2u);
+    EXPECT_EQ(s.subscribers[0].id, fast.id());
+    EXPECT_EQ(s.subscribers[1].id, slow.id());
+    EXPECT_EQ(s.subscribers[1].latency.count, 11u);
+    EXPECT_GE(s.subscribers[1].latency.p50, 200'000u);
+    EXPECT_LT(s.subscribers[0].latency.p50, s.subscribers[1].latency.p50);
+}
+
+TEST(EventStatsTest, KeyFilteredSubscribersAreReported) {
+    struct Tick { std::string_view symbol; };
+    static constexpr auto by_symbol = key_of([](const Tick& t) { return t.symbol; });
+    auto ev = std::make_shared<Event<Tick>>();
+    auto a = ev->subscribe(by_symbol.is("A"), [](const Tick&) { });
+    auto b = ev->subscribe(by_symbol.is("B"), [](const Tick&) { });
+    ev->publish(Tick{"A"});
+    ev->publish(Tick{"C"});
+
+    const EventStats s = ev->stats();
+    EXPECT_EQ(s.publishes, 2u);
+    EXPECT_EQ(s.deliveries, 1u);
+    ASSERT_EQ(s.subscribers.size(), 2u);
+    // IDs come from the per-key Events and may repeat across keys.
+    EXPECT_EQ(s.subscribers[0].latency.count + s.subscribers[1].latency.count, 1u);
+}
+
+TEST(EventStatsTest, BusReportsTopicsAndPatterns) {
+    EventBus<int> bus;
+    auto cpu = bus.subscribe("cpu.load", [](int) { });
+    auto any = bus.subscribe("cpu.#", [](int) { });
+    bus.publish("cpu.load", 1);
+    bus.publish("cpu.temp", 2);
+
+    const auto stats = bus.stats();
+    ASSERT_EQ(stats.size(), 3u);
+    EXPECT_EQ(stats[0].topic, "cpu.#");
+    EXPECT_EQ(stats[0].stats.deliveries, 2u);
+    EXPECT_EQ(stats[1].topic, "cpu.load");
+    EXPECT_EQ(stats[1].stats.deliveries, 1u);
+    EXPECT_EQ(stats[2].topic, "cpu.temp");
+    EXPECT_EQ(stats[2].stats.publishes, 1u);
+    EXPECT_TRUE(stats[2].stats.subscribers.empty());
+}
@@ -0,0 +1,145 @@
+#include <gtest/gtest.h>
+
+#include <atomic>
+#include <coroutine>
+#include <exception>
+#include <memory>
+#include <thread>
+#include <tuple>
+#include <vector>
+
+#include "event.hpp"
+
+using namespace stel;
+
+// Minimal eager, fire-and-forget coroutine; done() once it ran off the end.
+struct Coro {
+    struct promise_type {
+        Coro get_return_object() { return Coro{std::coroutine_handle<promise_type>::from_promise(*this)}; }
+        std::suspend_never initial_suspend() noexcept { return {}; }
+        std::suspend_always final_suspend() noexcept { return {}; }
+        void return_void() { }
+        void unhandled_exception() { std::terminate(); }
+    };
+
+    explicit Coro(std::coroutine_handle<promise_type> h) : h(h) { }
+    Coro(Coro&& other) noexcept : h(std::exchange(other.h, nullptr)) { }
+    ~Coro() { if (h) h.destroy(); }
+
+    bool done() const { return h.done(); }
+
+    std::coroutine_handle<promise_type> h;
+};
+
+Coro collect(Event<int>::Stream& events, std::vector<int>& out) {
+    while (auto e = co_await events.next()) {
+        out.push_back(std::get<0>(*e));
+    }
+}
+
+TEST(EventStreamTest, ResumesInlineOnPublish) {
+    auto ev = std::make_shared<Event<int>>();
+    auto events = ev->stream();
+    std::vector<int> seen;
+    Coro t = collect(events, seen);
+    EXPECT_FALSE(t.done());
+
+    ev->publish(1);
+    ev->publish(2);
+    EXPECT_EQ(seen, (std::vector<int>{1, 2}));
+    EXPECT_EQ(events.stats().delivered, 2u);
+}
+
+TEST(EventStreamTest, QueuedEventsAreReadWithoutSuspending) {
+    auto ev = std::make_shared<Event<int>>();
+    auto events = ev->stream();
+    for (int i = 0; i < 5; i++) {
+        ev->publish(i);
+    }
+    std::vector<int> seen;
+    Coro t = collect(events, seen);
+    EXPECT_EQ(seen, (std::vector<int>{0, 1, 2, 3, 4}));
+    EXPECT_FALSE(t.done());
+}
+
+TEST(EventStreamTest, EndsWhenEventIsDestroyed) {
+    auto ev = std::make_shared<Event<int>>();
+    auto events = ev->stream();
+    std::vector<int> seen;
+    Coro t = collect(events, seen);
+    ev->publish(7);
+    ev.reset();
+    EXPECT_TRUE(t.done());
+    EXPECT_EQ(seen, (std::vector<int>{7}));
+}
+
+TEST(EventStreamTest, EndsWhenUnsubscribed) {
+    auto ev = std::make_shared<Event<int>>();
+    auto events = ev->stream();
+    std::vector<int> seen;
+    Coro t = collect(events, seen);
+    ev->clear();
+    EXPECT_TRUE(t.done());
+    ev->publish(1);
+    EXPECT_TRUE(seen.empty());
+}
+
+TEST(EventStreamTest, DropNewestCountsOverflow) {
+    auto ev = std::make_shared<Event<int>>();
+    auto events = ev->stream(StreamOptions{4, Backpressure::DropNewest, nullptr});
+    for (int i = 0; i < 10; i++) {
+        ev->publish(i);
+    }
+    EXPECT_EQ(events.stats().queued, 4u);
+    EXPECT_EQ(events.stats().dropped, 6u);
+}
+
+Coro await_once(Event<int, int>& ev, std::atomic<int>& sum) {
+    auto e = co_await ev.next();
+    sum = std::get<0>(*e) + std::get<1>(*e);
+}
+
+TEST(EventStreamTest, NextTakesOneEventAndUnsubscribes) {
+    auto ev = std::make_shared<Event<int, int>>();
+    std::atomic<int> sum{0};
+    Coro t = await_once(*ev, sum);
+    EXPECT_EQ(ev->subscriber_count(), 1u);
+    ev->publish(2, 3);
+    EXPECT_TRUE(t.done());
+    EXPECT_EQ(sum.load(), 5);
+    EXPECT_EQ(ev->subscriber_count(), 0u);
+}
+
+TEST(EventStreamTest, ResumesOnExecutorAcrossThreads) {
+    auto ev = std::make_shared<Event<int>>();
+    auto exec = std::make_shared<ThreadPoolExecutor>(1);
+    auto events = ev->stream(StreamOptions{64, Backpressure::Block, exec});
+    std::atomic<long> sum{0};
+    std::atomic<bool> finished{false};
+    auto consume = [](Event<int>::Stream& s, std::atomic<long>& total, std::atomic<bool>& fin) -> Coro {
+        while (auto e = co_await s.next()) {
+            total += std::get<0>(*e);
+        }
+        fin = true;
+    };
+    Coro t = consume(events, sum, finished);
+
+    constexpr int kPerThread = 5000;
+    std::vector<std::thread> publishers;
+    for (int p = 0; p < 2; p++) {
+        publishers.emplace_back([&] {
+            for (int i = 1; i <= kPerThread; i++) {
+                ev->publish(i);
+            }
+        });
+    }
+    for (auto& th : publishers) {
+        th.join();
+    }
+    ev.reset();
+    while (!finished.load()) {
+        std::this_thread::yield();
+    }
+    exec->flush();
+    EXPECT_EQ(sum.load(), 2L * kPerThread * (kPerThread + 1) / 2);
+}
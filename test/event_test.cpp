@@ -0,0 +1,764 @@
+#include <gtest/gtest.h>
+
+#include <atomic>
+#include <exception>
+#include <functional>
+#include <memory>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "event.hpp"
+
+using namespace stel;
+
+TEST(EventTest, PublishReachesAllSubscribers) {
+    auto ev = std::make_shared<Event<int>>();
+    int a = 0, b = 0;
+    auto s1 = ev->subscribe([&](int v) { a += v; });
+    auto s2 = ev->subscribe([&](int v) { b += v; });
+
+    ev->publish(3);
+    EXPECT_EQ(a, 3);
+    EXPECT_EQ(b, 3);
+    EXPECT_EQ(ev->subscriber_count(), 2u);
+}
+
+TEST(EventTest, SubscriptionUnsubscribesOnDestruction) {
+    auto ev = std::make_shared<Event<int>>();
+    int calls = 0;
+    {
+        auto s = ev->subscribe([&](int) { calls++; });
+        ev->publish(1);
+    }
+    ev->publish(2);
+    EXPECT_EQ(calls, 1);
+    EXPECT_EQ(ev->subscriber_count(), 0u);
+}
+
+TEST(EventTest, ManualUnsubscribeAndMove) {
+    auto ev = std::make_shared<Event<std::string>>();
+    int calls = 0;
+    auto s = ev->subscribe([&](const std::string&) { calls++; });
+    Event<std::string>::Subscription moved = std::move(s);
+    EXPECT_FALSE(s);
+    EXPECT_TRUE(moved);
+
+    EXPECT_TRUE(moved.unsubscribe());
+    EXPECT_FALSE(moved.unsubscribe());
+    ev->publish("x");
+    EXPECT_EQ(calls, 0);
+}
+
+TEST(EventTest, SubscriptionOutlivesEvent) {
+    Event<int>::Subscription s;
+    {
+        auto ev = std::make_shared<Event<int>>();
+        s = ev->subscribe([](int) { });
+    }
+    EXPECT_FALSE(s.unsubscribe());
+}
+
+TEST(EventTest, ClearRemovesEverything) {
+    auto ev = std::make_shared<Event<int>>();
+    int calls = 0;
+    auto s1 = ev->subscribe([&](int) { calls++; });
+    auto s2 = ev->subscribe([&](int) { calls++; });
+    ev->clear();
+    ev->publish(1);
+    EXPECT_EQ(calls, 0);
+    EXPECT_EQ(ev->subscriber_count(), 0u);
+}
+
+TEST(EventTest, UnsubscribeFromInsideCallback) {
+    auto ev = std::make_shared<Event<int>>();
+    int calls = 0;
+    Event<int>::Subscription self;
+    self = ev->subscribe([&](int) {
+        calls++;
+        self.unsubscribe();
+    });
+    ev->publish(1);
+    ev->publish(2);
+    EXPECT_EQ(calls, 1);
+}
+
+TEST(EventTest, MoveOnlyAndMemberCallbacks) {
+    struct Sink {
+        void on(int v) { total += v; }
+        int total = 0;
+    } sink;
+
+    auto ev = std::make_shared<Event<int>>();
+    auto owned = std::make_unique<int>(0);
+    int* seen = owned.get();
+    auto s1 = ev->subscribe([p = std::move(owned)](int v) { *p += v; });
+    auto s2 = ev->subscribe(Event<int>::Callback::bind<&Sink::on>(&sink));
+
+    ev->publish(4);
+    EXPECT_EQ(*seen, 4);
+    EXPECT_EQ(sink.total, 4);
+}
+
+TEST(EventTest, BatchUnsubscribe) {
+    auto ev = std::make_shared<Event<int>>();
+    int calls = 0;
+    std::vector<Event<int>::Subscription> subs;
+    std::vector<std::size_t> ids;
+    for (int i = 0; i < 100; i++) {
+        subs.push_back(ev->subscribe([&](int) { calls++; }));
+    }
+    for (std::size_t id = 1; id <= 100; id++) {
+        ids.push_back(id);
+    }
+
+    const std::size_t half = 50;
+    EXPECT_EQ(ev->unsubscribe(std::span<const std::size_t>(ids.data(), half)), half);
+    EXPECT_EQ(ev->subscriber_count(), 50u);
+    ev->publish(1);
+    EXPECT_EQ(calls, 50);
+
+    // Already removed IDs are not counted twice.
+    EXPECT_EQ(ev->unsubscribe(std::span<const std::size_t>(ids)), 50u);
+    EXPECT_EQ(ev->subscriber_count(), 0u);
+}
+
+TEST(EventTest, TombstonesAreSkippedUntilCompaction) {
+    auto ev = std::make_shared<Event<int>>();
+    std::vector<int> calls(10, 0);
+    std::vector<Event<int>::Subscription> subs;
+    for (int i = 0; i < 10; i++) {
+        subs.push_back(ev->subscribe([&calls, i](int) { calls[i]++; }));
+    }
+    // Remove every other subscriber, one at a time.
+    for (int i = 0; i < 10; i += 2) {
+        subs[i].unsubscribe();
+        ev->publish(0);
+    }
+    for (int i = 0; i < 10; i++) {
+        EXPECT_EQ(calls[i], i % 2 == 0 ? i / 2 : 5) << "subscriber " << i;
+    }
+    EXPECT_EQ(ev->subscriber_count(), 5u);
+}
+
+TEST(EventTest, ConcurrentPublishAndSubscribe) {
+    auto ev = std::make_shared<Event<int>>();
+    std::atomic<long> delivered{0};
+    auto base = ev->subscribe([&](int) { delivered.fetch_add(1, std::memory_order_relaxed); });
+
+    std::atomic<bool> stop{false};
+    std::vector<std::thread> publishers;
+    for (int t = 0; t < 4; t++) {
+        publishers.emplace_back([&] {
+            for (int i = 0; i < 2000; i++) {
+                ev->publish(i);
+            }
+        });
+    }
+    std::thread churn([&] {
+        while (!stop.load()) {
+            auto s = ev->subscribe([](int) { });
+        }
+    });
+
+    for (auto& t : publishers) {
+        t.join();
+    }
+    stop.store(true);
+    churn.join();
+
+    EXPECT_EQ(delivered.load(), 4 * 2000);
+    EXPECT_EQ(ev->subscriber_count(), 1u);
+}
+
+TEST(EventTest, TransactionCommitsOnce) {
+    auto ev = std::make_shared<Event<int>>();
+    int a = 0, b = 0;
+    auto old = ev->subscribe([&](int) { a += 100; });
+
+    auto tx = ev->transaction();
+    EXPECT_EQ(tx.subscribe([&](int v) { a += v; }), 0u);
+    EXPECT_EQ(tx.subscribe([&](int v) { b += v; }), 1u);
+    tx.unsubscribe(std::move(old));
+    EXPECT_FALSE(old);
+
+    // Nothing is applied before commit.
+    ev->publish(1);
+    EXPECT_EQ(a, 100);
+    EXPECT_EQ(b, 0);
+
+    auto subs = tx.commit();
+    ASSERT_EQ(subs.size(), 2u);
+    EXPECT_TRUE(tx.empty());
+    ev->publish(1);
+    EXPECT_EQ(a, 101);
+    EXPECT_EQ(b, 1);
+
+    subs[0].unsubscribe();
+    ev->publish(1);
+    EXPECT_EQ(a, 101);
+    EXPECT_EQ(b, 2);
+}
+
+TEST(EventTest, SubscribeMany) {
+    auto ev = std::make_shared<Event<int>>();
+    int total = 0;
+    std::vector<Event<int>::Callback> cbs;
+    for (int i = 0; i < 1000; i++) {
+        cbs.emplace_back([&total](int v) { total += v; });
+    }
+    auto subs = ev->subscribe_many(std::move(cbs));
+    EXPECT_EQ(subs.size(), 1000u);
+    EXPECT_EQ(ev->subscriber_count(), 1000u);
+    ev->publish(1);
+    EXPECT_EQ(total, 1000);
+
+    subs.clear();
+    EXPECT_EQ(ev->subscriber_count(), 0u);
+}
+
+template <typename R>
+concept SubscribableRange = requires(Event<int>& ev, R&& r) { ev.subscribe_many(std::forward<R>(r)); };
+
+TEST(EventTest, SubscribeManyCopiesFromLvalueRanges) {
+    auto ev = std::make_shared<Event<int>>();
+    int total = 0;
+    std::vector<std::function<void(int)>> cbs(10, [&total](int v) { total += v; });
+    auto subs = ev->subscribe_many(cbs);
+    EXPECT_EQ(subs.size(), 10u);
+    EXPECT_EQ(cbs.size(), 10u);
+    EXPECT_TRUE(cbs.front());
+    ev->publish(2);
+    EXPECT_EQ(total, 20);
+
+    static_assert(SubscribableRange<std::vector<Event<int>::Callback>>);
+    static_assert(!SubscribableRange<std::vector<Event<int>::Callback>&>);
+}
+
+TEST(EventTest, AsyncPublishRunsOnDispatcherThreads) {
+    auto ev = std::make_shared<Event<int>>(AsyncOptions{2, 64, Backpressure::Block});
+    EXPECT_TRUE(ev->is_async());
+
+    const auto publisher = std::this_thread::get_id();
+    std::atomic<int> sum{0};
+    std::atomic<int> on_publisher{0};
+    auto s = ev->subscribe([&](int v) {
+        sum.fetch_add(v);
+        if (std::this_thread::get_id() == publisher) on_publisher.fetch_add(1);
+    });
+
+    for (int i = 1; i <= 100; i++) {
+        ev->publish(i);
+    }
+    ev->flush();
+    EXPECT_EQ(sum.load(), 5050);
+    EXPECT_EQ(on_publisher.load(), 0);
+    EXPECT_EQ(ev->dropped_count(), 0u);
+}
+
+TEST(EventTest, AsyncEventDeliversQueuedOnDestruction) {
+    std::atomic<int> calls{0};
+    Event<std::string>::Subscription s;
+    {
+        auto ev = std::make_shared<Event<std::string>>(AsyncOptions{});
+        s = ev->subscribe([&](const std::string&) { calls.fetch_add(1); });
+        for (int i = 0; i < 50; i++) {
+            ev->publish("x");
+        }
+    }
+    EXPECT_EQ(calls.load(), 50);
+}
+
+TEST(EventTest, SlowMailboxSubscriberDoesNotBlockOthers) {
+    auto ev = std::make_shared<Event<int>>();
+    std::atomic<bool> release{false};
+    std::atomic<int> fast{0};
+    std::atomic<int> slow{0};
+
+    auto s_slow = ev->subscribe([&](int) {
+        while (!release.load()) std::this_thread::yield();
+        slow.fetch_add(1);
+    }, MailboxOptions{4, Backpressure::DropNewest, nullptr});
+    auto s_fast = ev->subscribe([&](int) { fast.fetch_add(1); },
+            MailboxOptions{1024, Backpressure::Block, nullptr});
+
+    for (int i = 0; i < 100; i++) {
+        ev->publish(i);
+    }
+    while (fast.load() < 100) std::this_thread::yield();
+
+    const auto stats = ev->mailbox_stats(s_slow.id());
+    EXPECT_GT(stats.dropped, 0u);
+    release.store(true);
+    while (ev->mailbox_stats(s_slow.id()).delivered + stats.dropped < 100) std::this_thread::yield();
+    EXPECT_EQ(ev->mailbox_stats(s_fast.id()).delivered, 100u);
+}
+
+TEST(EventTest, UnsubscribedMailboxStopsDelivering) {
+    auto ev = std::make_shared<Event<int>>();
+    auto exec = std::make_shared<ThreadPoolExecutor>(1);
+    std::atomic<int> calls{0};
+    auto s = ev->subscribe([&](int) { calls.fetch_add(1); },
+            MailboxOptions{64, Backpressure::Block, exec});
+    ev->publish(1);
+    while (calls.load() < 1) std::this_thread::yield();
+
+    s.unsubscribe();
+    ev->publish(2);
+    exec->flush();
+    EXPECT_EQ(calls.load(), 1);
+}
+
+TEST(EventTest, ExceptionsAreRoutedToHandler) {
+    auto ev = std::make_shared<Event<int>>();
+    std::vector<std::size_t> failed;
+    std::string what;
+    ev->set_error_handler([&](std::size_t id, std::exception_ptr e) {
+        failed.push_back(id);
+        try {
+            std::rethrow_exception(e);
+        } catch (const std::runtime_error& err) {
+            what = err.what();
+        }
+    });
+    int after = 0;
+    auto bad = ev->subscribe([](int) { throw std::runtime_error("boom"); });
+    auto good = ev->subscribe([&](int) noexcept { after++; });
+
+    ev->publish(1);
+    EXPECT_EQ(after, 1);
+    ASSERT_EQ(failed.size(), 1u);
+    EXPECT_EQ(failed[0], bad.id());
+    EXPECT_EQ(what, "boom");
+    EXPECT_EQ(ev->failure_count(), 1u);
+
+    // Without a handler exceptions are swallowed but still counted.
+    ev->set_error_handler(nullptr);
+    ev->publish(2);
+    EXPECT_EQ(failed.size(), 1u);
+    EXPECT_EQ(ev->failure_count(), 2u);
+}
+
+TEST(EventTest, SubscriberMayDropTheLastReference) {
+    auto ev = std::make_shared<Event<int>>();
+    std::vector<std::size_t> failed;
+    ev->set_error_handler([&](std::size_t id, std::exception_ptr) { failed.push_back(id); });
+    Event<int>* raw = ev.get();
+    auto drop = raw->subscribe([&](int) { ev.reset(); });
+    auto bad = raw->subscribe([](int) { throw std::runtime_error("after"); });
+
+    raw->publish(1);
+    EXPECT_EQ(ev, nullptr);
+    ASSERT_EQ(failed.size(), 1u);
+    EXPECT_EQ(failed[0], bad.id());
+    EXPECT_FALSE(bad.unsubscribe());
+}
+
+TEST(EventTest, MailboxExceptionsAreRouted) {
+    auto ev = std::make_shared<Event<int>>();
+    auto exec = std::make_shared<ThreadPoolExecutor>(1);
+    std::atomic<std::size_t> failed_id{0};
+    ev->set_error_handler([&](std::size_t id, std::exception_ptr) { failed_id.store(id); });
+    auto s = ev->subscribe([](int) { throw std::logic_error("late"); },
+            MailboxOptions{8, Backpressure::Block, exec});
+    ev->publish(1);
+    exec->flush();
+    EXPECT_EQ(failed_id.load(), s.id());
+    EXPECT_EQ(ev->failure_count(), 1u);
+}
+
+TEST(EventTest, PublishBatchReachesEverySubscriberKind) {
+    auto ev = std::make_shared<Event<int, int>>();
+    auto exec = std::make_shared<InlineExecutor>();
+    int sum = 0, batches = 0, batch_items = 0, mailbox_sum = 0;
+    auto s1 = ev->subscribe([&](int a, int b) { sum += a * b; });
+    auto s2 = ev->subscribe_batch([&](Event<int, int>::Batch events) {
+        batches++;
+        batch_items += static_cast<int>(events.size());
+    });
+    auto s3 = ev->subscribe([&](int a, int) { mailbox_sum += a; },
+            MailboxOptions{16, Backpressure::Block, exec});
+
+    const std::vector<std::tuple<int, int>> events = {{1, 2}, {3, 4}, {5, 6}};
+    ev->publish_batch(events);
+    EXPECT_EQ(sum, 2 + 12 + 30);
+    EXPECT_EQ(batches, 1);
+    EXPECT_EQ(batch_items, 3);
+    EXPECT_EQ(mailbox_sum, 9);
+
+    // A single publish reaches batch subscribers as a span of one.
+    ev->publish(7, 1);
+    EXPECT_EQ(batches, 2);
+    EXPECT_EQ(batch_items, 4);
+}
+
+TEST(EventTest, PublishBatchRoutesExceptionsPerEvent) {
+    auto ev = std::make_shared<Event<int>>();
+    int seen = 0;
+    auto s = ev->subscribe([&](int v) {
+        seen++;
+        if (v == 2) throw std::runtime_error("bad sample");
+    });
+    const std::vector<std::tuple<int>> events = {{1}, {2}, {3}};
+    ev->publish_batch(events);
+    EXPECT_EQ(seen, 3);
+    EXPECT_EQ(ev->failure_count(), 1u);
+}
+
+TEST(EventTest, AsyncPublishBatch) {
+    auto ev = std::make_shared<Event<int>>(AsyncOptions{1, 64, Backpressure::Block});
+    std::atomic<int> sum{0};
+    auto s = ev->subscribe_batch([&](Event<int>::Batch events) {
+        for (const auto& [v] : events) sum += v;
+    });
+    std::vector<std::tuple<int>> events;
+    for (int i = 1; i <= 100; i++) events.emplace_back(i);
+    ev->publish_batch(events);
+    ev->flush();
+    EXPECT_EQ(sum.load(), 5050);
+}
+
+TEST(EventTest, LatestValueSubscribers) {
+    auto ev = std::make_shared<Event<std::string, double>>();
+    auto exec = std::make_shared<ThreadPoolExecutor>(1);
+    std::atomic<bool> open{false};
+    std::vector<std::string> prices;
+    auto sub = ev->subscribe_latest([&](const std::string& sym, double px) {
+        while (!open.load()) std::this_thread::yield();
+        prices.push_back(sym + "=" + std::to_string(static_cast<int>(px)));
+    }, [](const std::string& sym, double) { return sym; }, exec);
+
+    ev->publish("A", 0);
+    while (ev->mailbox_stats(sub.id()).queued != 0) std::this_thread::yield();
+    for (int i = 1; i <= 10; i++) {
+        ev->publish("A", i);
+        ev->publish("B", 100 + i);
+    }
+    open.store(true);
+    exec->flush();
+    EXPECT_EQ(prices, (std::vector<std::string>{"A=0", "A=10", "B=110"}));
+    EXPECT_EQ(ev->mailbox_stats(sub.id()).dropped, 18u);
+}
+
+TEST(EventTest, PrioritiesOrderDispatch) {
+    auto ev = std::make_shared<Event<int>>();
+    std::vector<std::string> order;
+    auto log = ev->subscribe([&](int) { order.push_back("log"); }, -10);
+    auto a = ev->subscribe([&](int) { order.push_back("a"); });
+    auto risk = ev->subscribe([&](int) { order.push_back("risk"); }, 100);
+    auto b = ev->subscribe([&](int) { order.push_back("b"); });
+
+    auto tx = ev->transaction();
+    tx.subscribe([&](int) { order.push_back("audit"); }, -10);
+    tx.subscribe([&](int) { order.push_back("limits"); }, 50);
+    auto more = tx.commit();
+
+    ev->publish(0);
+    EXPECT_EQ(order, (std::vector<std::string>{"risk", "limits", "a", "b", "log", "audit"}));
+
+    // Order survives unsubscribes and compaction.
+    a.unsubscribe();
+    risk.unsubscribe();
+    log.unsubscribe();
+    order.clear();
+    ev->publish(0);
+    EXPECT_EQ(order, (std::vector<std::string>{"limits", "b", "audit"}));
+}
+
+namespace {
+struct Tick {
+    std::string symbol;
+    int venue = 0;
+    double px = 0;
+};
+
+inline const auto by_symbol = key_of([](const Tick& t) { return std::string_view(t.symbol); });
+inline const auto by_venue = key_of([](const Tick& t) { return t.venue; });
+} // namespace
+
+TEST(EventTest, KeyFiltersOnlyCallMatchingSubscribers) {
+    auto ev = std::make_shared<Event<Tick>>();
+    int aapl = 0, msft = 0, venue1 = 0, all = 0;
+    auto s1 = ev->subscribe(by_symbol.is("AAPL"), [&](const Tick&) { aapl++; });
+    auto s2 = ev->subscribe(by_symbol.is(std::string("MSFT")), [&](const Tick&) { msft++; });
+    auto s3 = ev->subscribe(by_venue.is(1), [&](const Tick&) { venue1++; });
+    auto s4 = ev->subscribe([&](const Tick&) { all++; });
+    EXPECT_EQ(ev->subscriber_count(), 4u);
+
+    ev->publish(Tick{"AAPL", 1, 1.0});
+    ev->publish(Tick{"MSFT", 2, 2.0});
+    ev->publish(Tick{"IBM", 1, 3.0});
+    EXPECT_EQ(aapl, 1);
+    EXPECT_EQ(msft, 1);
+    EXPECT_EQ(venue1, 2);
+    EXPECT_EQ(all, 3);
+
+    s1.unsubscribe();
+    ev->publish(Tick{"AAPL", 0, 1.0});
+    EXPECT_EQ(aapl, 1);
+    EXPECT_EQ(ev->subscriber_count(), 3u);
+
+    ev->clear();
+    EXPECT_EQ(ev->subscriber_count(), 0u);
+    ev->publish(Tick{"MSFT", 1, 2.0});
+    EXPECT_EQ(msft, 1);
+    EXPECT_EQ(venue1, 2);
+}
+
+TEST(EventTest, SubscriberCountStaysSaneWhileIndexesComeAndGo) {
+    auto ev = std::make_shared<Event<Tick>>();
+    std::atomic<bool> stop{false};
+    std::thread churn([&] {
+        while (!stop.load()) {
+            auto s = ev->subscribe(by_venue.is(1), [](const Tick&) { });
+            ev->clear();
+        }
+    });
+    for (int i = 0; i < 20000; i++) {
+        ASSERT_LE(ev->subscriber_count(), 1u);
+    }
+    stop = true;
+    churn.join();
+}
+
+TEST(EventTest, KeyFilteredSubscribersShareErrorRouting) {
+    auto ev = std::make_shared<Event<Tick>>();
+    std::size_t failed = 0;
+    ev->set_error_handler([&](std::size_t id, std::exception_ptr) { failed = id; });
+    auto s = ev->subscribe(by_symbol.is("X"), [](const Tick&) { throw std::runtime_error("x"); });
+    ev->publish(Tick{"X", 0, 0});
+    EXPECT_EQ(failed, s.id());
+    EXPECT_EQ(ev->failure_count(), 1u);
+}
+
+namespace {
+int tick_venue(const Tick& t) { return t.venue; }
+int tick_px(const Tick& t) { return static_cast<int>(t.px); }
+
+// Index key counting its live copies.
+struct Venue {
+    explicit Venue(int v) : v(v) { alive++; }
+    Venue(const Venue& other) : v(other.v) { alive++; }
+    ~Venue() { alive--; }
+    bool operator ==(const Venue& other) const { return v == other.v; }
+
+    int v;
+    static inline int alive = 0;
+};
+} // namespace
+
+template <>
+struct std::hash<Venue> {
+    std::size_t operator ()(const Venue& k) const noexcept { return std::hash<int>{}(k.v); }
+};
+
+TEST(EventTest, KeyIndexesAreToldApartByProjectionValue) {
+    auto ev = std::make_shared<Event<Tick>>();
+    int venue = 0, px = 0;
+    auto a = ev->subscribe(key_of(&tick_venue).is(1), [&](const Tick&) { venue++; });
+    auto b = ev->subscribe(key_of(&tick_px).is(1), [&](const Tick&) { px++; });
+    ev->publish(Tick{"A", 1, 2.0});
+    EXPECT_EQ(venue, 1);
+    EXPECT_EQ(px, 0);
+    ev->publish(Tick{"A", 2, 1.0});
+    EXPECT_EQ(venue, 1);
+    EXPECT_EQ(px, 1);
+    EXPECT_EQ(ev->subscriber_count(), 2u);
+}
+
+TEST(EventTest, KeysWithoutSubscribersAreDropped) {
+    auto ev = std::make_shared<Event<Tick>>();
+    const auto by_key = key_of([](const Tick& t) { return Venue(t.venue); });
+    int calls = 0;
+    auto kept = ev->subscribe(by_key.is(Venue(-1)), [&](const Tick&) { calls++; });
+    for (int i = 0; i < 1000; i++) {
+        auto s = ev->subscribe(by_key.is(Venue(i)), [&](const Tick&) { calls++; });
+    }
+    for (int i = 0; i < 3; i++) {
+        EpochDomain::instance().collect();
+    }
+    EXPECT_LE(Venue::alive, 128);
+    ev->publish(Tick{"A", -1, 0});
+    ev->publish(Tick{"A", 999, 0});
+    EXPECT_EQ(calls, 1);
+    EXPECT_EQ(ev->subscriber_count(), 1u);
+}
+
+TEST(EventTest, TokensDroppedInsidePublishFreeNothingThere) {
+    struct Probe {
+        Probe(const bool& publishing, int& inside, int& outside) : publishing(publishing), inside(inside), outside(outside) { }
+        ~Probe() { (publishing ? inside : outside)++; }
+        const bool& publishing;
+        int& inside;
+        int& outside;
+    };
+    auto ev = std::make_shared<Event<int>>();
+    bool publishing = false;
+    int inside = 0, outside = 0;
+    std::vector<Event<int>::Subscription> subs;
+    for (int i = 0; i < 8; i++) {
+        auto probe = std::make_shared<Probe>(publishing, inside, outside);
+        subs.push_back(ev->subscribe([probe](int) { }));
+    }
+    // Compacted away, so only the tokens still hold these slots.
+    for (auto& s : subs) {
+        ev->unsubscribe(s.id());
+    }
+    auto dropper = ev->subscribe([&](int) {
+        publishing = true;
+        subs.clear();
+        publishing = false;
+    });
+    ev->publish(1);
+    EpochDomain::instance().collect();
+    EXPECT_EQ(inside, 0);
+    EXPECT_EQ(outside, 8);
+}
+
+TEST(EventTest, RetiredSnapshotsOutliveEvent) {
+    std::atomic<int> calls{0};
+    {
+        EpochGuard pin;
+        auto ev = std::make_shared<Event<int>>();
+        for (int i = 0; i < 16; i++) {
+            auto s = ev->subscribe([&](int) { calls++; });
+            ev->publish(i);
+        }
+        // Everything retired above is still pinned, and comes back to the
+        // snapshot pool only after ev is gone.
+    }
+    EpochDomain::instance().collect();
+    EXPECT_EQ(calls.load(), 16);
+}
+
+TEST(EventTest, StatsWithoutInstrumentationTrackFailures) {
+    auto ev = std::make_shared<Event<int>>();
+    auto s = ev->subscribe([](int) { throw std::runtime_error("x"); });
+    ev->publish(1);
+    const EventStats stats = ev->stats();
+    EXPECT_EQ(stats.failures, 1u);
+    EXPECT_EQ(stats.publishes, 0u);
+    ASSERT_EQ(stats.subscribers.size(), 1u);
+    EXPECT_EQ(stats.subscribers[0].id, s.id());
+}
+
+TEST(EventTest, TokensReleaseWithoutTheEvent) {
+    auto ev = std::make_shared<Event<int>>();
+    int calls = 0;
+    std::vector<Event<int>::Subscription> subs;
+    for (int i = 0; i < 200; i++) {
+        subs.push_back(ev->subscribe([&](int) { calls++; }));
+    }
+    for (int i = 0; i < 150; i++) {
+        EXPECT_TRUE(subs[i].unsubscribe());
+        EXPECT_FALSE(subs[i].unsubscribe());
+    }
+    EXPECT_EQ(ev->subscriber_count(), 50u);
+    ev->publish(1);
+    EXPECT_EQ(calls, 50);
+
+    // Whoever gets there first removes the subscriber, once.
+    EXPECT_TRUE(ev->unsubscribe(subs[150].id()));
+    EXPECT_FALSE(subs[150].unsubscribe());
+    ev->clear();
+    EXPECT_FALSE(subs[151].unsubscribe());
+    EXPECT_EQ(ev->subscriber_count(), 0u);
+}
+
+TEST(EventTest, SubscriptionGroupRemovesAcrossEvents) {
+    auto a = std::make_shared<Event<int>>();
+    auto b = std::make_shared<Event<int>>();
+    int calls = 0;
+    SubscriptionGroup<int> group;
+    for (int i = 0; i < 100; i++) {
+        group += a->subscribe([&](int) { calls++; });
+        group += b->subscribe([&](int) { calls++; });
+    }
+    auto keep = a->subscribe([&](int) { calls++; });
+    {
+        auto tx = b->transaction();
+        tx.subscribe([&](int) { calls++; });
+        group.add(tx.commit());
+    }
+    EXPECT_EQ(group.size(), 201u);
+    EXPECT_EQ(group.clear(), 201u);
+    EXPECT_TRUE(group.empty());
+    EXPECT_EQ(a->subscriber_count(), 1u);
+    EXPECT_EQ(b->subscriber_count(), 0u);
+    a->publish(1);
+    b->publish(1);
+    EXPECT_EQ(calls, 1);
+
+    // Members may outlive their Event.
+    group += b->subscribe([](int) { });
+    b.reset();
+    EXPECT_EQ(group.clear(), 0u);
+}
+
+TEST(EventTest, ConcurrentTokenAndIdUnsubscribe) {
+    auto ev = std::make_shared<Event<int>>();
+    std::vector<Event<int>::Subscription> subs;
+    for (int i = 0; i < 1000; i++) {
+        subs.push_back(ev->subscribe([](int) { }));
+    }
+    std::atomic<std::size_t> released{0};
+    std::thread t([&] {
+        for (std::size_t i = 0; i < 500; i++) {
+            released += subs[i].unsubscribe();
+        }
+    });
+    std::size_t ids = 0;
+    for (std::size_t i = 500; i < 1000; i++) {
+        ids += ev->unsubscribe(subs[i].id());
+        if (i == 750) std::this_thread::yield();
+    }
+    t.join();
+    EXPECT_EQ(released.load() + ids, 1000u);
+    EXPECT_EQ(ev->subscriber_count(), 0u);
+}
+
+TEST(EventTest, ParallelFanOutReachesEverySubscriber) {
+    auto pool = std::make_shared<FanoutPool>(FanoutOptions{3, 64});
+    auto ev = std::make_shared<Event<int>>(pool);
+    std::atomic<long> sum{0};
+    std::vector<Event<int>::Subscription> subs;
+    for (int i = 0; i < 1000; i++) {
+        subs.push_back(ev->subscribe([&](int v) { sum += v; }));
+    }
+    auto exec = std::make_shared<ThreadPoolExecutor>(1);
+    std::atomic<int> queued{0};
+    subs.push_back(ev->subscribe([&](int) { queued++; }, MailboxOptions{64, Backpressure::Block, exec}));
+    std::atomic<int> batched{0};
+    subs.push_back(ev->subscribe_batch([&](Event<int>::Batch b) { batched += static_cast<int>(b.size()); }));
+    subs[10].unsubscribe();
+
+    for (int i = 1; i <= 10; i++) {
+        ev->publish(i);
+    }
+    exec->flush();
+    EXPECT_EQ(sum.load(), 999L * 55);
+    EXPECT_EQ(queued.load(), 10);
+    EXPECT_EQ(batched.load(), 10);
+}
+
+TEST(EventTest, ParallelFanOutKeepsMovedInEnvelope) {
+    auto pool = std::make_shared<FanoutPool>(FanoutOptions{2, 4, {}});
+    auto ev = std::make_shared<Event<std::string>>(pool);
+    auto exec = std::make_shared<ThreadPoolExecutor>(1);
+    std::atomic<int> queued{0};
+    std::vector<Event<std::string>::Subscription> subs;
+    subs.push_back(ev->subscribe([&](const std::string& s) { queued += s.size() == 200 && s.back() == 'x'; },
+            MailboxOptions{64, Backpressure::Block, exec}));
+    std::atomic<int> seen{0};
+    for (int i = 0; i < 64; i++) {
+        subs.push_back(ev->subscribe([&](const std::string& s) { seen += s.size() == 200 && s.back() == 'x'; }));
+    }
+
+    for (int i = 0; i < 10; i++) {
+        ev->publish(std::string(200, 'x'));
+    }
+    exec->flush();
+    EXPECT_EQ(seen.load(), 640);
+    EXPECT_EQ(queued.load(), 10);
+}
@@ -0,0 +1,74 @@
+#include <gtest/gtest.h>
+
+#include <atomic>
+#include <cstddef>
+#include <thread>
+#include <vector>
+
+#include "fanout_pool.hpp"
+
+using namespace stel;
+
+TEST(FanoutPoolTest, CoversEveryIndexOnce) {
+    FanoutPool pool(FanoutOptions{3, 16});
+    std::vector<std::atomic<int>> hits(1000);
+    pool.run(hits.size(), [&](std::size_t b, std::size_t e) {
+        for (std::size_t i = b; i < e; i++) hits[i]++;
+    });
+    for (const auto& h : hits) {
+        EXPECT_EQ(h.load(), 1);
+    }
+}
+
+TEST(FanoutPoolTest, SmallLoopsRunInline) {
+    FanoutPool pool(FanoutOptions{2, 64});
+    const auto caller = std::this_thread::get_id();
+    bool inline_run = false;
+    pool.run(64, [&](std::size_t b, std::size_t e) {
+        inline_run = b == 0 && e == 64 && std::this_thread::get_id() == caller;
+    });
+    EXPECT_TRUE(inline_run);
+    pool.run(0, [](std::size_t, std::size_t) { FAIL(); });
+}
+
+TEST(FanoutPoolTest, BusyHelperDoesNotHoldUpTheLoop) {
+    FanoutPool pool(FanoutOptions{2, 1});
+    std::atomic<bool> release{false};
+    std::atomic<bool> blocked{false};
+    // Occupy one helper with a chunk that waits for us.
+    std::thread slow([&] {
+        pool.run(2, [&](std::size_t b, std::size_t) {
+            if (b != 0) return;
+            blocked = true;
+            while (!release.load()) std::this_thread::yield();
+        });
+    });
+    while (!blocked.load()) std::this_thread::yield();
+
+    std::atomic<int> sum{0};
+    pool.run(100, [&](std::size_t b, std::size_t e) { sum += static_cast<int>(e - b); });
+    EXPECT_EQ(sum.load(), 100);
+    release = true;
+    slow.join();
+}
+
+TEST(FanoutPoolTest, NestedAndConcurrentRuns) {
+    FanoutPool pool(FanoutOptions{2, 4});
+    std::atomic<long> total{0};
+    std::vector<std::thread> callers;
+    for (int t = 0; t < 3; t++) {
+        callers.emplace_back([&] {
+            for (int r = 0; r < 20; r++) {
+                pool.run(16, [&](std::size_t b, std::size_t e) {
+                    for (std::size_t i = b; i < e; i++) {
+                        pool.run(8, [&](std::size_t b2, std::size_t e2) { total += static_cast<long>(e2 - b2); });
+                    }
+                });
+            }
+        });
+    }
+    for (auto& c : callers) {
+        c.join();
+    }
+    EXPECT_EQ(total.load(), 3L * 20 * 16 * 8);
+}
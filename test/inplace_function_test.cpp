@@ -0,0 +1,86 @@
+#include <gtest/gtest.h>
+
+#include <memory>
+#include <string>
+
+#include "inplace_function.hpp"
+
+using namespace stel;
+
+namespace {
+
+int twice(int v) { return v * 2; }
+
+struct Counter {
+    int add(int v) { total += v; return total; }
+    int total = 0;
+};
+
+struct Tracked {
+    explicit Tracked(int& d) : dtors(&d) { }
+    Tracked(Tracked&& o) noexcept : dtors(std::exchange(o.dtors, nullptr)) { }
+    ~Tracked() { if (dtors) ++*dtors; }
+    int operator()(int v) const { return v + 1; }
+    int* dtors;
+};
+
+} // namespace
+
+TEST(InplaceFunctionTest, IsOneCacheLine) {
+    EXPECT_EQ(sizeof(InplaceFunction<void(int)>), 64u);
+}
+
+TEST(InplaceFunctionTest, InvokerAndTargetCallLikeTheObject) {
+    int captured = 5;
+    InplaceFunction<int(int)> f = [captured](int v) { return v + captured; };
+    EXPECT_EQ(f.target(), static_cast<void*>(&f));
+    EXPECT_EQ(f.invoker()(f.target(), 1), 6);
+    EXPECT_EQ(InplaceFunction<int(int)>().invoker(), nullptr);
+}
+
+TEST(InplaceFunctionTest, InvokesLambdasAndFunctionPointers) {
+    int captured = 5;
+    InplaceFunction<int(int)> f = [captured](int v) { return v + captured; };
+    InplaceFunction<int(int)> g = &twice;
+    EXPECT_EQ(f(1), 6);
+    EXPECT_EQ(g(4), 8);
+}
+
+TEST(InplaceFunctionTest, EmptyAndNull) {
+    InplaceFunction<void()> f;
+    EXPECT_FALSE(f);
+    InplaceFunction<int(int)> g = static_cast<int (*)(int)>(nullptr);
+    EXPECT_FALSE(g);
+    g = &twice;
+    EXPECT_TRUE(g);
+    g = nullptr;
+    EXPECT_FALSE(g);
+}
+
+TEST(InplaceFunctionTest, BindsMemberFunctions) {
+    Counter c;
+    auto f = InplaceFunction<int(int)>::bind<&Counter::add>(&c);
+    f(2);
+    EXPECT_EQ(f(3), 5);
+    EXPECT_EQ(c.total, 5);
+}
+
+TEST(InplaceFunctionTest, HoldsMoveOnlyCallables) {
+    auto p = std::make_unique<std::string>("abc");
+    InplaceFunction<std::size_t()> f = [p = std::move(p)] { return p->size(); };
+    InplaceFunction<std::size_t()> g = std::move(f);
+    EXPECT_FALSE(f);
+    EXPECT_EQ(g(), 3u);
+}
+
+TEST(InplaceFunctionTest, DestroysTargetExactlyOnce) {
+    int dtors = 0;
+    {
+        InplaceFunction<int(int)> f = Tracked(dtors);
+        InplaceFunction<int(int)> g = std::move(f);
+        EXPECT_EQ(g(1), 2);
+        g = nullptr;
+        EXPECT_EQ(dtors, 1);
+    }
+    EXPECT_EQ(dtors, 1);
+}
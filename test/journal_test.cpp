@@ -0,0 +1,199 @@
+#include <gtest/gtest.h>
+
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <unistd.h>
+
+#include "event.hpp"
+
+using namespace stel;
+
+namespace {
+
+// Thread-safe record of what a follower saw.
+struct Seen {
+    void add(int v) {
+        std::lock_guard<std::mutex> lk(m);
+        values.push_back(v);
+    }
+    std::vector<int> get() {
+        std::lock_guard<std::mutex> lk(m);
+        return values;
+    }
+    std::mutex m;
+    std::vector<int> values;
+};
+
+std::vector<int> range(int from, int to) {
+    std::vector<int> v;
+    for (int i = from; i < to; i++) v.push_back(i);
+    return v;
+}
+
+// Per-process segment file, removed when the test ends.
+struct TempFile {
+    explicit TempFile(const char* tag)
+        : path("/tmp/stel-journal-" + std::to_string(::getpid()) + "-" + tag) { ::unlink(path.c_str()); }
+    ~TempFile() { ::unlink(path.c_str()); }
+    std::string path;
+};
+
+// Same layout, different meaning.
+struct Fill {
+    std::int64_t qty;
+    double price;
+};
+struct Quote {
+    std::int64_t size;
+    double bid;
+};
+struct QuoteV2 {
+    static constexpr std::uint64_t pod_version = 2;
+    std::int64_t size;
+    double bid;
+};
+
+} // namespace
+
+TEST(JournalTest, LateSubscriberReplaysThenFollows) {
+    EventBus<int> bus;
+    auto journal = bus.journal("orders", JournalOptions{64});
+    for (int i = 0; i < 10; i++) {
+        bus.publish("orders", i);
+    }
+    journal->flush();
+    EXPECT_EQ(journal->end(), 10u);
+
+    Seen seen;
+    auto cursor = bus.subscribe_from("orders", 4, [&](int v) { seen.add(v); });
+    for (int i = 10; i < 15; i++) {
+        bus.publish("orders", i);
+    }
+    journal->flush();
+    EXPECT_EQ(seen.get(), range(4, 15));
+    EXPECT_EQ(cursor.position(), 15u);
+    EXPECT_EQ(journal->end(), 15u);
+}
+
+TEST(JournalTest, NoGapOrDuplicateWhileJoiningUnderLoad) {
+    EventBus<int> bus;
+    auto journal = bus.journal("t", JournalOptions{1 << 14});
+    std::atomic<bool> stop{false};
+    std::thread publisher([&] {
+        for (int i = 0; i < 5000; i++) {
+            bus.publish("t", i);
+            if (i % 64 == 0) std::this_thread::yield();
+        }
+        stop = true;
+    });
+    std::vector<std::unique_ptr<Seen>> seen;
+    std::vector<Journal<int>::Cursor> cursors;
+    while (!stop.load()) {
+        seen.push_back(std::make_unique<Seen>());
+        Seen* s = seen.back().get();
+        cursors.push_back(bus.subscribe_from("t", 0, [s](int v) { s->add(v); }));
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+    publisher.join();
+    journal->flush();
+    EXPECT_FALSE(seen.empty());
+    for (auto& s : seen) {
+        EXPECT_EQ(s->get(), range(0, 5000));
+    }
+}
+
+TEST(JournalTest, LaggingFollowerSkipsEvictedEvents) {
+    EventBus<int> bus;
+    auto journal = bus.journal("t", JournalOptions{8});
+    for (int i = 0; i < 20; i++) {
+        bus.publish("t", i);
+    }
+    journal->flush();
+    EXPECT_EQ(journal->first(), 12u);
+
+    Seen seen;
+    auto cursor = bus.subscribe_from("t", 3, [&](int v) { seen.add(v); });
+    journal->flush();
+    EXPECT_EQ(seen.get(), range(12, 20));
+    EXPECT_EQ(cursor.lost(), 9u);
+}
+
+TEST(JournalTest, UnsubscribedCursorStops) {
+    EventBus<int> bus;
+    auto journal = bus.journal("t");
+    Seen seen;
+    auto cursor = bus.subscribe_from("t", 0, [&](int v) { seen.add(v); });
+    bus.publish("t", 1);
+    journal->flush();
+    cursor.unsubscribe();
+    bus.publish("t", 2);
+    journal->flush();
+    EXPECT_EQ(seen.get(), (std::vector<int>{1}));
+}
+
+TEST(JournalTest, OnlyJournaledLiteralTopics) {
+    EventBus<int> bus;
+    EXPECT_THROW(bus.subscribe_from("t", 0, [](int) { }), std::invalid_argument);
+    EXPECT_THROW(bus.journal("t.*"), std::invalid_argument);
+    EXPECT_EQ(bus.journal("t"), bus.journal("t", JournalOptions{2}));
+}
+
+TEST(JournalTest, SegmentFileSurvivesRestart) {
+    TempFile file("restart");
+    {
+        EventBus<int, double> bus;
+        auto journal = bus.journal("px", JournalOptions{16, file.path});
+        EXPECT_TRUE(journal->mapped());
+        for (int i = 0; i < 20; i++) {
+            bus.publish("px", i, i * 0.5);
+        }
+        journal->flush();
+        journal->sync();
+    }
+    EventBus<int, double> bus;
+    auto journal = bus.journal("px", JournalOptions{16, file.path});
+    EXPECT_EQ(journal->end(), 20u);
+    EXPECT_EQ(journal->first(), 4u);
+
+    std::mutex m;
+    std::vector<int> ints;
+    auto cursor = bus.subscribe_from("px", 0, [&](int i, double d) {
+        EXPECT_EQ(d, i * 0.5);
+        std::lock_guard<std::mutex> lk(m);
+        ints.push_back(i);
+    });
+    bus.publish("px", 20, 10.0);
+    journal->flush();
+    std::lock_guard<std::mutex> lk(m);
+    EXPECT_EQ(ints, range(4, 21));
+}
+
+TEST(JournalTest, SegmentFileRejectsOtherLayouts) {
+    TempFile file("layout");
+    { Journal<int> j(JournalOptions{16, file.path}); }
+    EXPECT_THROW(Journal<double>(JournalOptions{16, file.path}), std::invalid_argument);
+    EXPECT_THROW(Journal<int>(JournalOptions{32, file.path}), std::invalid_argument);
+    EXPECT_THROW(Journal<std::string>(JournalOptions{16, file.path}), std::invalid_argument);
+}
+
+TEST(JournalTest, SegmentFileRejectsOtherPayloadTypes) {
+    static_assert(Journal<Fill>::mappable);
+    static_assert(!Journal<const char*>::mappable);
+    static_assert(!Journal<int, const int*>::mappable);
+    EXPECT_NE(PodCodec<Fill>::signature, PodCodec<Quote>::signature);
+    EXPECT_NE(PodCodec<Quote>::signature, PodCodec<QuoteV2>::signature);
+
+    TempFile file("types");
+    { Journal<Fill> j(JournalOptions{16, file.path}); }
+    EXPECT_NO_THROW(Journal<Fill>(JournalOptions{16, file.path}));
+    EXPECT_THROW(Journal<Quote>(JournalOptions{16, file.path}), std::invalid_argument);
+    EXPECT_THROW(Journal<QuoteV2>(JournalOptions{16, file.path}), std::invalid_argument);
+    EXPECT_THROW(Journal<const char*>(JournalOptions{16, file.path}), std::invalid_argument);
+}
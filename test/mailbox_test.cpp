@@ -0,0 +1,138 @@
+#include <gtest/gtest.h>
+
+#include <atomic>
+#include <memory>
+#include <stdexcept>
+#include <thread>
+#include <utility>
+#include <variant>
+#include <vector>
+
+#include "conflating_mailbox.hpp"
+#include "envelope.hpp"
+#include "mailbox.hpp"
+#include "spsc_ring.hpp"
+
+using namespace stel;
+
+TEST(SpscRingTest, FifoAndBounded) {
+    SpscRing<int> ring(4);
+    for (int i = 0; i < 4; i++) {
+        EXPECT_TRUE(ring.try_push(i));
+    }
+    EXPECT_FALSE(ring.try_push(4));
+    EXPECT_EQ(ring.size(), 4u);
+
+    int v = -1;
+    for (int i = 0; i < 4; i++) {
+        ASSERT_TRUE(ring.try_pop(v));
+        EXPECT_EQ(v, i);
+    }
+    EXPECT_FALSE(ring.try_pop(v));
+    EXPECT_TRUE(ring.empty());
+}
+
+TEST(SpscRingTest, ProducerConsumerThreads) {
+    SpscRing<long> ring(32);
+    constexpr long kCount = 100000;
+    long sum = 0;
+    std::thread consumer([&] {
+        long v;
+        for (long n = 0; n < kCount;) {
+            if (ring.try_pop(v)) {
+                sum += v;
+                n++;
+            } else {
+                std::this_thread::yield();
+            }
+        }
+    });
+    for (long i = 1; i <= kCount; i++) {
+        while (!ring.try_push(i)) std::this_thread::yield();
+    }
+    consumer.join();
+    EXPECT_EQ(sum, kCount * (kCount + 1) / 2);
+}
+
+TEST(MailboxTest, DeliversInOrderOnExecutor) {
+    auto exec = std::make_shared<ThreadPoolExecutor>(1);
+    auto pool = EnvelopePool<int>::create();
+    std::atomic<int> last{0};
+    std::atomic<bool> ordered{true};
+    auto mb = std::make_shared<Mailbox<int>>(MailboxOptions{16, Backpressure::Block, exec},
+            [&](int v) {
+                if (v != last.load() + 1) ordered.store(false);
+                last.store(v);
+            });
+    for (int i = 1; i <= 1000; i++) {
+        EXPECT_TRUE(mb->offer(pool->make(i)));
+    }
+    while (mb->stats().delivered < 1000) std::this_thread::yield();
+    EXPECT_TRUE(ordered.load());
+    EXPECT_EQ(last.load(), 1000);
+}
+
+TEST(MailboxTest, DropNewestCountsDrops) {
+    std::atomic<bool> open{false};
+    auto pool = EnvelopePool<int>::create();
+    auto mb = std::make_shared<Mailbox<int>>(MailboxOptions{2, Backpressure::DropNewest, nullptr},
+            [&](int) { while (!open.load()) std::this_thread::yield(); });
+    int accepted = 0;
+    for (int i = 0; i < 10; i++) {
+        accepted += mb->offer(pool->make(i));
+    }
+    // One item may already be in the handler, two more fit the ring.
+    EXPECT_LE(accepted, 3);
+    EXPECT_EQ(mb->stats().dropped, static_cast<std::uint64_t>(10 - accepted));
+    open.store(true);
+    while (mb->stats().delivered < static_cast<std::uint64_t>(accepted)) std::this_thread::yield();
+}
+
+TEST(MailboxTest, RejectsDropOldest) {
+    EXPECT_THROW(Mailbox<int>(MailboxOptions{8, Backpressure::DropOldest, nullptr}, [](int) { }),
+            std::invalid_argument);
+}
+
+TEST(ConflatingMailboxTest, KeepsOnlyLatestValue) {
+    auto exec = std::make_shared<ThreadPoolExecutor>(1);
+    auto pool = EnvelopePool<int>::create();
+    std::atomic<bool> open{false};
+    std::vector<int> seen;
+    auto mb = std::make_shared<ConflatingMailbox<std::monostate, int>>(exec, [&](int v) {
+        while (!open.load()) std::this_thread::yield();
+        seen.push_back(v);
+    });
+    EXPECT_TRUE(mb->offer(pool->make(0)));
+    // Wait for 0 to be taken by the blocked drain, then pile up.
+    while (mb->stats().queued != 0) std::this_thread::yield();
+    for (int i = 1; i <= 100; i++) {
+        EXPECT_TRUE(mb->offer(pool->make(i)));
+    }
+    EXPECT_EQ(mb->stats().queued, 1u);
+    EXPECT_EQ(mb->stats().dropped, 99u);
+    open.store(true);
+    exec->flush();
+    EXPECT_EQ(seen, (std::vector<int>{0, 100}));
+}
+
+TEST(ConflatingMailboxTest, KeepsLatestPerKey) {
+    auto exec = std::make_shared<ThreadPoolExecutor>(1);
+    auto pool = EnvelopePool<int, int>::create();
+    std::atomic<bool> open{false};
+    std::vector<std::pair<int, int>> seen;
+    auto mb = std::make_shared<ConflatingMailbox<int, int, int>>(exec,
+            [&](int key, int v) {
+                while (!open.load()) std::this_thread::yield();
+                seen.emplace_back(key, v);
+            },
+            [](int key, int) { return key; });
+    mb->offer(pool->make(-1, 0));
+    while (mb->stats().queued != 0) std::this_thread::yield();
+    for (int i = 0; i < 30; i++) {
+        mb->offer(pool->make(i % 3, i));
+    }
+    EXPECT_EQ(mb->stats().queued, 3u);
+    open.store(true);
+    exec->flush();
+    EXPECT_EQ(seen, (std::vector<std::pair<int, int>>{{-1, 0}, {0, 27}, {1, 28}, {2, 29}}));
+}
@@ -0,0 +1,70 @@
+#include <gtest/gtest.h>
+
+#include <atomic>
+#include <memory>
+#include <thread>
+#include <vector>
+
+#include "mpmc_queue.hpp"
+
+using namespace stel;
+
+TEST(MpmcQueueTest, FifoAndBounded) {
+    MpmcQueue<int> q(3);
+    EXPECT_EQ(q.capacity(), 4u);
+    for (int i = 0; i < 4; i++) {
+        EXPECT_TRUE(q.try_push(i));
+    }
+    EXPECT_FALSE(q.try_push(99));
+
+    int v = -1;
+    for (int i = 0; i < 4; i++) {
+        ASSERT_TRUE(q.try_pop(v));
+        EXPECT_EQ(v, i);
+    }
+    EXPECT_FALSE(q.try_pop(v));
+}
+
+TEST(MpmcQueueTest, DestroysQueuedItems) {
+    auto item = std::make_shared<int>(1);
+    {
+        MpmcQueue<std::shared_ptr<int>> q(8);
+        q.try_push(item);
+        q.try_push(item);
+        EXPECT_EQ(item.use_count(), 3);
+    }
+    EXPECT_EQ(item.use_count(), 1);
+}
+
+TEST(MpmcQueueTest, ConcurrentProducersAndConsumers) {
+    MpmcQueue<int> q(64);
+    constexpr int kPerProducer = 20000;
+    std::atomic<long> sum{0};
+    std::atomic<int> popped{0};
+
+    std::vector<std::thread> threads;
+    for (int p = 0; p < 2; p++) {
+        threads.emplace_back([&] {
+            for (int i = 1; i <= kPerProducer; i++) {
+                while (!q.try_push(i)) std::this_thread::yield();
+            }
+        });
+    }
+    for (int c = 0; c < 2; c++) {
+        threads.emplace_back([&] {
+            int v;
+            while (popped.load() < 2 * kPerProducer) {
+                if (q.try_pop(v)) {
+                    sum.fetch_add(v);
+                    popped.fetch_add(1);
+                } else {
+                    std::this_thread::yield();
+                }
+            }
+        });
+    }
+    for (auto& t : threads) {
+        t.join();
+    }
+    EXPECT_EQ(sum.load(), 2L * kPerProducer * (kPerProducer + 1) / 2);
+}
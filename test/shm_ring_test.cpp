@@ -0,0 +1,133 @@
+#include <gtest/gtest.h>
+
+#include <atomic>
+#include <cerrno>
+#include <chrono>
+#include <cstdint>
+#include <memory>
+#include <stdexcept>
+#include <string>
+#include <system_error>
+#include <thread>
+
+#include <sys/wait.h>
+#include <unistd.h>
+
+#include "shm_ring.hpp"
+
+using namespace stel;
+
+struct Quote {
+    char symbol[8];
+    double price;
+    std::uint64_t seq;
+};
+
+// Per-process names, removed when the test ends.
+struct ShmName {
+    explicit ShmName(const char* tag) : name("/stel-test-" + std::to_string(::getpid()) + "-" + tag) { }
+    ~ShmName() { ShmRing<int>::unlink(name); }
+    std::string name;
+};
+
+TEST(ShmRingTest, SecondMappingSeesPublishes) {
+    ShmName shm("roundtrip");
+    auto writer = ShmRing<int, Quote>::create(shm.name, 16);
+    auto mapped = ShmRing<int, Quote>::open(shm.name);
+    EXPECT_EQ(mapped->capacity(), 16u);
+
+    auto reader = mapped->reader();
+    EXPECT_FALSE(reader.wait(std::chrono::milliseconds(1)));
+    writer->publish(7, Quote{"AAPL", 1.5, 1});
+    writer->publish(8, Quote{"MSFT", 2.5, 2});
+    ASSERT_TRUE(reader.wait(std::chrono::milliseconds(1)));
+
+    int sum = 0;
+    double prices = 0;
+    EXPECT_EQ(reader.poll([&](int v, const Quote& q) { sum += v; prices += q.price; }), 2u);
+    EXPECT_EQ(sum, 15);
+    EXPECT_DOUBLE_EQ(prices, 4.0);
+    EXPECT_EQ(reader.lost(), 0u);
+}
+
+TEST(ShmRingTest, LappedReaderSkipsAhead) {
+    ShmName shm("lapped");
+    auto ring = ShmRing<std::uint64_t>::create(shm.name, 8);
+    auto reader = ring->reader();
+    for (std::uint64_t i = 0; i < 20; i++) ring->publish(i);
+
+    std::uint64_t first = 0, n = 0;
+    reader.poll([&](std::uint64_t v) { if (n++ == 0) first = v; });
+    EXPECT_EQ(n, 8u);
+    EXPECT_EQ(first, 12u);
+    EXPECT_EQ(reader.lost(), 12u);
+}
+
+TEST(ShmRingTest, OpenChecksNameAndPayload) {
+    ShmName shm("payload");
+    EXPECT_THROW(ShmRing<int>::open(shm.name), std::system_error);
+    auto ring = ShmRing<int>::create(shm.name, 8);
+    EXPECT_THROW(ShmRing<Quote>::open(shm.name), std::invalid_argument);
+}
+
+TEST(ShmRingTest, CreateLeavesALiveRingAlone) {
+    ShmName shm("exclusive");
+    auto ring = ShmRing<int>::create(shm.name, 8);
+    auto reader = ring->reader();
+    ring->publish(1);
+    try {
+        ShmRing<int>::create(shm.name, 8);
+        FAIL() << "create() reinitialized a live ring";
+    } catch (const std::system_error& e) {
+        EXPECT_EQ(e.code().value(), EEXIST);
+    }
+    int got = 0;
+    EXPECT_EQ(reader.poll([&](int v) { got = v; }), 1u);
+    EXPECT_EQ(got, 1);
+
+    // Once the name is released it can be created again.
+    ShmRing<int>::unlink(shm.name);
+    EXPECT_NO_THROW(ShmRing<int>::create(shm.name, 8));
+}
+
+TEST(ShmRingTest, ReachesAnotherProcess) {
+    ShmName shm("fork");
+    auto ring = ShmRing<std::uint64_t>::create(shm.name, 1024);
+    auto reader = ring->reader();
+    constexpr std::uint64_t kCount = 500;
+
+    const pid_t child = ::fork();
+    ASSERT_GE(child, 0);
+    if (child == 0) {
+        auto mine = ShmRing<std::uint64_t>::open(shm.name);
+        for (std::uint64_t i = 1; i <= kCount; i++) mine->publish(i);
+        ::_exit(0);
+    }
+
+    std::uint64_t sum = 0, n = 0;
+    const auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds(10);
+    while (n < kCount && std::chrono::steady_clock::now() < deadline) {
+        reader.wait(std::chrono::milliseconds(10));
+        n += reader.poll([&](std::uint64_t v) { sum += v; });
+    }
+    int status = 0;
+    ::waitpid(child, &status, 0);
+    EXPECT_EQ(n, kCount);
+    EXPECT_EQ(sum, kCount * (kCount + 1) / 2);
+}
+
+TEST(ShmRingTest, ExportAndImportEvents) {
+    ShmName shm("bridge");
+    auto ring = ShmRing<int>::create(shm.name, 64);
+    auto source = std::make_shared<Event<int>>();
+    auto sink = std::make_shared<Event<int>>();
+    std::atomic<int> sum{0};
+    auto got = sink->subscribe([&](int v) { sum += v; });
+    {
+        ShmImport<int> in(ShmRing<int>::open(shm.name), sink);
+        auto out = shm_export(source, ring);
+        for (int i = 1; i <= 10; i++) source->publish(i);
+        for (int spins = 0; sum.load() != 55 && spins < 10000; spins++) std::this_thread::yield();
+    }
+    EXPECT_EQ(sum.load(), 55);
+}
@@ -0,0 +1,58 @@
+#include <gtest/gtest.h>
+
+#include <cstddef>
+#include <string>
+#include <vector>
+
+#include "static_bus.hpp"
+
+using namespace stel;
+
+namespace topics {
+struct CpuLoad : StaticTopic<"cpu.load", double> {};
+struct Log : StaticTopic<"log", int, std::string> {};
+using Tick = StaticTopic<"tick">;
+} // namespace topics
+
+using Bus = StaticBus<topics::CpuLoad, topics::Log, topics::Tick>;
+
+static_assert(Bus::index_of<topics::CpuLoad>() == 0);
+static_assert(Bus::index_of<topics::Tick>() == 2);
+static_assert(topics::CpuLoad::name == "cpu.load");
+static_assert(topics::CpuLoad::id == topic_hash("cpu.load"));
+static_assert(topics::CpuLoad::id != topics::Log::id);
+
+TEST(StaticBusTest, RoutesByTopicType) {
+    Bus bus;
+    double load = 0;
+    std::vector<std::string> lines;
+    int ticks = 0;
+    auto s1 = bus.subscribe<topics::CpuLoad>([&](double v) { load = v; });
+    auto s2 = bus.subscribe<topics::Log>([&](int level, const std::string& msg) {
+        lines.push_back(std::to_string(level) + ":" + msg);
+    });
+    auto s3 = bus.subscribe<topics::Tick>([&] { ticks++; });
+
+    bus.publish<topics::CpuLoad>(0.75);
+    bus.publish<topics::Log>(2, std::string("hello"));
+    bus.publish<topics::Tick>();
+    bus.publish<topics::Tick>();
+
+    EXPECT_DOUBLE_EQ(load, 0.75);
+    EXPECT_EQ(lines, std::vector<std::string>{"2:hello"});
+    EXPECT_EQ(ticks, 2);
+    EXPECT_EQ(bus.subscriber_count<topics::Log>(), 1u);
+}
+
+TEST(StaticBusTest, SubscriptionsUnsubscribe) {
+    Bus bus;
+    int calls = 0;
+    {
+        auto sub = bus.subscribe<topics::CpuLoad>([&](double) { calls++; });
+        bus.publish<topics::CpuLoad>(1.0);
+    }
+    bus.publish<topics::CpuLoad>(1.0);
+    EXPECT_EQ(calls, 1);
+    EXPECT_EQ(bus.subscriber_count<topics::CpuLoad>(), 0u);
+    EXPECT_EQ(bus.event<topics::CpuLoad>()->subscriber_count(), 0u);
+}
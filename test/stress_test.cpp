@@ -0,0 +1,316 @@
+#include <gtest/gtest.h>
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <cstdlib>
+#include <memory>
+#include <mutex>
+#include <random>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "event.hpp"
+
+using namespace stel;
+
+// Randomized publish/subscribe/unsubscribe/clear against one Event or
+// EventBus, checking delivery invariants afterwards. Run it under TSan with
+// -DSTEL_SANITIZE=thread; scale it with STEL_STRESS_MS (per scenario),
+// STEL_STRESS_PUBLISHERS, STEL_STRESS_CHURNERS and STEL_STRESS_SEED.
+//
+// Every publisher owns a sequence 1, 2, 3, ... and marks each publish as
+// started before calling publish and completed once it returned. Then, for
+// a subscriber whose subscribe() returned before it read started = lo and
+// which read completed = hi before unsubscribing, every publish in (lo, hi]
+// must reach it exactly once, in order.
+
+namespace {
+
+std::uint64_t env_or(const char* name, std::uint64_t fallback) {
+    const char* v = std::getenv(name);
+    return v && *v ? std::strtoull(v, nullptr, 10) : fallback;
+}
+
+struct Load {
+    std::chrono::milliseconds duration{env_or("STEL_STRESS_MS", 300)};
+    std::size_t publishers = env_or("STEL_STRESS_PUBLISHERS", 3);
+    std::size_t churners = env_or("STEL_STRESS_CHURNERS", 2);
+    std::uint64_t seed = env_or("STEL_STRESS_SEED", std::random_device{}());
+};
+
+struct alignas(64) Source {
+    std::atomic<std::uint64_t> started{0};
+    std::atomic<std::uint64_t> completed{0};
+};
+
+// What one subscriber got from one source; written by that source only.
+struct Trace {
+    void see(std::uint64_t seq) {
+        if (count == 0) {
+            first = seq;
+        } else if (seq != last + 1) {
+            ordered = false;
+        }
+        last = seq;
+        count++;
+    }
+
+    std::uint64_t first = 0;
+    std::uint64_t last = 0;
+    std::uint64_t count = 0;
+    bool ordered = true;
+};
+
+struct Probe {
+    explicit Probe(std::size_t sources) : traces(sources), lo(sources), hi(sources), relevant(sources, true) { }
+
+    std::vector<Trace> traces;
+    std::vector<std::uint64_t> lo;
+    std::vector<std::uint64_t> hi;
+    std::vector<bool> relevant;     // Sources whose events it subscribed to
+    std::uint64_t clears_from = 0;  // Clears finished before subscribe
+    std::uint64_t clears_to = 0;    // Clears begun before hi was read
+};
+
+class Harness {
+public:
+    explicit Harness(const Load& load) : load_(load), sources_(load.publishers), cleared_at_(kMaxClears) { }
+
+    // publish(source, seq) until the run ends, one thread per source.
+    template <typename Publish>
+    void start_publishers(Publish publish) {
+        for (std::size_t s = 0; s < sources_.size(); s++) {
+            threads_.emplace_back([this, s, publish] {
+                Source& src = sources_[s];
+                for (std::uint64_t seq = 1; !stop_.load(std::memory_order_relaxed); seq++) {
+                    src.started.store(seq);
+                    publish(static_cast<std::uint32_t>(s), seq);
+                    src.completed.store(seq);
+                    publishes_.fetch_add(1, std::memory_order_relaxed);
+                }
+            });
+        }
+    }
+
+    std::shared_ptr<Probe> begin_probe() {
+        auto probe = std::make_shared<Probe>(sources_.size());
+        probe->clears_from = clears_done_.load();
+        std::lock_guard<std::mutex> lk(probes_mtx_);
+        probes_.push_back(probe);
+        return probe;
+    }
+
+    // Call right after subscribe() returned.
+    void subscribed(Probe& probe) {
+        for (std::size_t s = 0; s < sources_.size(); s++) {
+            probe.lo[s] = sources_[s].started.load();
+        }
+    }
+
+    // Call right before unsubscribing.
+    void unsubscribing(Probe& probe) {
+        for (std::size_t s = 0; s < sources_.size(); s++) {
+            probe.hi[s] = sources_[s].completed.load();
+        }
+        probe.clears_to = clears_begun_.load();
+    }
+
+    // Run clear() as one numbered clear, recording how far every source had
+    // got before it started.
+    template <typename Clear>
+    bool clear(Clear&& fn) {
+        std::lock_guard<std::mutex> lk(clear_mtx_);
+        const std::uint64_t k = clears_begun_.load();
+        if (k >= kMaxClears) return false;
+        cleared_at_[k].resize(sources_.size());
+        for (std::size_t s = 0; s < sources_.size(); s++) {
+            cleared_at_[k][s] = sources_[s].completed.load();
+        }
+        clears_begun_.store(k + 1);
+        fn();
+        clears_done_.store(k + 1);
+        return true;
+    }
+
+    // Run churn(thread, rng, deadline) on each churner, then stop the publishers.
+    template <typename Churn>
+    void run(Churn churn) {
+        const auto deadline = std::chrono::steady_clock::now() + load_.duration;
+        std::vector<std::thread> churners;
+        for (std::size_t c = 0; c < load_.churners; c++) {
+            churners.emplace_back([&, c] {
+                std::mt19937_64 rng(load_.seed + c);
+                churn(rng, deadline);
+            });
+        }
+        for (auto& t : churners) {
+            t.join();
+        }
+        stop_.store(true);
+        for (auto& t : threads_) {
+            t.join();
+        }
+    }
+
+    void verify() const {
+        std::size_t checked = 0;
+        for (const auto& probe : probes_) {
+            for (std::size_t s = 0; s < sources_.size(); s++) {
+                const Trace& t = probe->traces[s];
+                EXPECT_TRUE(t.ordered) << "duplicate, lost or reordered event from source " << s;
+                if (!probe->relevant[s]) {
+                    EXPECT_EQ(t.count, 0u) << "event from an unrelated source " << s;
+                    continue;
+                }
+                std::uint64_t hi = probe->hi[s];
+                if (probe->clears_from < probe->clears_to) {
+                    hi = std::min(hi, cleared_at_[probe->clears_from][s]);
+                }
+                if (hi <= probe->lo[s]) continue;
+                checked++;
+                EXPECT_GT(t.count, 0u) << "source " << s << " events (" << probe->lo[s] << ", " << hi << "] lost";
+                if (t.count == 0) continue;
+                EXPECT_LE(t.first, probe->lo[s] + 1) << "source " << s << " events lost after subscribe";
+                EXPECT_GE(t.last, hi) << "source " << s << " events lost before unsubscribe";
+            }
+        }
+        EXPECT_GT(publishes_.load(), 0u);
+        ::testing::Test::RecordProperty("probes", static_cast<int>(probes_.size()));
+        ::testing::Test::RecordProperty("checked", static_cast<int>(checked));
+        ::testing::Test::RecordProperty("clears", static_cast<int>(clears_done_.load()));
+        ::testing::Test::RecordProperty("seed", std::to_string(load_.seed));
+    }
+
+    std::size_t sources() const { return sources_.size(); }
+
+private:
+    static constexpr std::size_t kMaxClears = 4096;
+
+    const Load load_;
+    std::vector<Source> sources_;
+    std::vector<std::thread> threads_;
+    std::atomic<bool> stop_{false};
+    std::atomic<std::uint64_t> publishes_{0};
+
+    std::mutex probes_mtx_;
+    std::vector<std::shared_ptr<Probe>> probes_;
+
+    std::mutex clear_mtx_;
+    std::vector<std::vector<std::uint64_t>> cleared_at_;  // Index: clear number
+    std::atomic<std::uint64_t> clears_begun_{0};
+    std::atomic<std::uint64_t> clears_done_{0};
+};
+
+template <typename Sub>
+struct Active {
+    std::shared_ptr<Probe> probe;
+    Sub sub;
+};
+
+} // namespace
+
+TEST(StressTest, EventChurnKeepsDeliveryInvariants) {
+    const Load load;
+    Harness h(load);
+    auto ev = std::make_shared<Event<std::uint32_t, std::uint64_t>>();
+    using Sub = Event<std::uint32_t, std::uint64_t>::Subscription;
+
+    h.start_publishers([ev](std::uint32_t s, std::uint64_t seq) { ev->publish(s, seq); });
+    h.run([&](std::mt19937_64& rng, auto deadline) {
+        std::vector<Active<Sub>> active;
+        while (std::chrono::steady_clock::now() < deadline) {
+            const unsigned op = rng() % 100;
+            if (op < 45 || active.empty()) {
+                auto probe = h.begin_probe();
+                Probe* p = probe.get();
+                const int priority = static_cast<int>(rng() % 5) - 2;
+                Sub sub = ev->subscribe([p](std::uint32_t s, std::uint64_t seq) { p->traces[s].see(seq); },
+                        priority);
+                h.subscribed(*p);
+                active.push_back({std::move(probe), std::move(sub)});
+            } else if (op < 98) {
+                const std::size_t i = rng() % active.size();
+                h.unsubscribing(*active[i].probe);
+                switch (op % 3) {
+                case 0: active[i].sub.unsubscribe(); break;
+                case 1: ev->unsubscribe(active[i].sub.id()); break;
+                default: break;     // Dropping the token below
+                }
+                active.erase(active.begin() + i);
+            } else {
+                h.clear([&] { ev->clear(); });
+            }
+            if (active.size() > 64) {
+                h.unsubscribing(*active.front().probe);
+                active.erase(active.begin());
+            }
+        }
+        // Publishers are still running: close the remaining windows now.
+        for (auto& a : active) {
+            h.unsubscribing(*a.probe);
+        }
+        active.clear();
+    });
+    h.verify();
+}
+
+TEST(StressTest, BusChurnKeepsDeliveryInvariants) {
+    const Load load;
+    Harness h(load);
+    EventBus<std::uint32_t, std::uint64_t> bus;
+    using Sub = EventBus<std::uint32_t, std::uint64_t>::EventType::Subscription;
+
+    std::vector<std::string> topics;
+    for (std::size_t s = 0; s < h.sources(); s++) {
+        topics.push_back("stress." + std::to_string(s));
+    }
+    const std::vector<std::string> patterns{"stress.*", "#"};
+
+    h.start_publishers([&bus, &topics](std::uint32_t s, std::uint64_t seq) { bus.publish(topics[s], s, seq); });
+    std::atomic<std::uint64_t> spare{0};
+    h.run([&](std::mt19937_64& rng, auto deadline) {
+        std::vector<Active<Sub>> active;
+        while (std::chrono::steady_clock::now() < deadline) {
+            const unsigned op = rng() % 100;
+            if (op < 45 || active.empty()) {
+                auto probe = h.begin_probe();
+                Probe* p = probe.get();
+                auto cb = [p](std::uint32_t s, std::uint64_t seq) { p->traces[s].see(seq); };
+                Sub sub;
+                if (op % 4 == 0) {
+                    sub = bus.subscribe(patterns[rng() % patterns.size()], cb);
+                } else {
+                    const std::size_t s = rng() % h.sources();
+                    p->relevant.assign(h.sources(), false);
+                    p->relevant[s] = true;
+                    sub = bus.subscribe(topics[s], cb);
+                }
+                h.subscribed(*p);
+                active.push_back({std::move(probe), std::move(sub)});
+            } else if (op < 95) {
+                const std::size_t i = rng() % active.size();
+                h.unsubscribing(*active[i].probe);
+                active.erase(active.begin() + i);
+            } else {
+                // Topics coming and going next to the busy ones.
+                auto probe = h.begin_probe();
+                probe->relevant.assign(h.sources(), false);
+                Probe* p = probe.get();
+                auto sub = bus.subscribe("stress.spare." + std::to_string(spare++),
+                        [p](std::uint32_t s, std::uint64_t seq) { p->traces[s].see(seq); });
+            }
+            if (active.size() > 64) {
+                h.unsubscribing(*active.front().probe);
+                active.erase(active.begin());
+            }
+        }
+        for (auto& a : active) {
+            h.unsubscribing(*a.probe);
+        }
+        active.clear();
+    });
+    h.verify();
+}
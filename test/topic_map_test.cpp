@@ -0,0 +1,88 @@
+#include <gtest/gtest.h>
+
+#include <atomic>
+#include <string>
+#include <thread>
+
+#include "topic_map.hpp"
+
+using namespace stel;
+
+TEST(TopicMapTest, FindOrEmplaceAndFind) {
+    TopicMap<int> map;
+    EpochGuard g;
+    EXPECT_EQ(map.find("a"), nullptr);
+
+    map.find_or_emplace("a", [] { return 1; });
+    map.find_or_emplace("a", [] { return 2; });
+    ASSERT_NE(map.find("a"), nullptr);
+    EXPECT_EQ(*map.find("a"), 1);
+    EXPECT_EQ(map.size(), 1u);
+}
+
+TEST(TopicMapTest, GrowKeepsAllKeys) {
+    TopicMap<int> map;
+    for (int i = 0; i < 5000; i++) {
+        map.find_or_emplace(std::to_string(i), [i] { return i; });
+    }
+    EpochGuard g;
+    for (int i = 0; i < 5000; i++) {
+        auto* v = map.find(std::to_string(i));
+        ASSERT_NE(v, nullptr);
+        EXPECT_EQ(*v, i);
+    }
+    EXPECT_EQ(map.size(), 5000u);
+}
+
+TEST(TopicMapTest, ReadersNeverMissExistingKeysDuringGrowth) {
+    TopicMap<int> map;
+    map.find_or_emplace("stable", [] { return 7; });
+
+    std::atomic<bool> stop{false};
+    std::atomic<int> misses{0};
+    std::thread reader([&] {
+        while (!stop.load()) {
+            EpochGuard g;
+            auto* v = map.find("stable");
+            if (!v || *v != 7) misses.fetch_add(1);
+        }
+    });
+
+    for (int i = 0; i < 20000; i++) {
+        map.find_or_emplace("k" + std::to_string(i), [i] { return i; });
+    }
+    stop.store(true);
+    reader.join();
+    EXPECT_EQ(misses.load(), 0);
+}
+
+TEST(TopicMapTest, NonStringKeys) {
+    TopicMap<int, long> map;
+    for (long i = 0; i < 100; i++) {
+        map.find_or_emplace(i * 7, [i] { return static_cast<int>(i); });
+    }
+    EpochGuard g;
+    ASSERT_NE(map.find(14), nullptr);
+    EXPECT_EQ(*map.find(14), 2);
+    EXPECT_EQ(map.find(15), nullptr);
+}
+
+TEST(TopicMapTest, EraseIfRemovesAndShrinks) {
+    TopicMap<int> map;
+    for (int i = 0; i < 1000; i++) {
+        map.find_or_emplace(std::to_string(i), [i] { return i; });
+    }
+    EXPECT_EQ(map.erase_if([](std::string_view, int v) { return v % 100 != 0; }), 990u);
+    EXPECT_EQ(map.size(), 10u);
+
+    EpochGuard g;
+    for (int i = 0; i < 1000; i++) {
+        auto* v = map.find(std::to_string(i));
+        if (i % 100 == 0) {
+            ASSERT_NE(v, nullptr);
+            EXPECT_EQ(*v, i);
+        } else {
+            EXPECT_EQ(v, nullptr);
+        }
+    }
+}
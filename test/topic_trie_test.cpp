@@ -0,0 +1,85 @@
+#include <gtest/gtest.h>
+
+#include <algorithm>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include "topic_trie.hpp"
+
+using namespace stel;
+
+static std::vector<int> matching(TopicTrie<int>& trie, std::string_view topic) {
+    std::vector<int> out;
+    trie.match(topic, [&](int& v) { out.push_back(v); });
+    std::sort(out.begin(), out.end());
+    return out;
+}
+
+TEST(TopicTrieTest, DetectsPatterns) {
+    EXPECT_FALSE(TopicTrie<int>::is_pattern("cpu.core3.temp"));
+    EXPECT_FALSE(TopicTrie<int>::is_pattern("cpu.core*"));
+    EXPECT_TRUE(TopicTrie<int>::is_pattern("cpu.*.temp"));
+    EXPECT_TRUE(TopicTrie<int>::is_pattern("cpu.#"));
+    EXPECT_TRUE(TopicTrie<int>::is_pattern("#"));
+}
+
+TEST(TopicTrieTest, MatchesWildcards) {
+    TopicTrie<int> trie;
+    trie.find_or_emplace("cpu.core3.temp", [] { return 1; });
+    trie.find_or_emplace("cpu.*.temp", [] { return 2; });
+    trie.find_or_emplace("cpu.#", [] { return 3; });
+    trie.find_or_emplace("#", [] { return 4; });
+    trie.find_or_emplace("mem.*", [] { return 5; });
+    EXPECT_EQ(trie.size(), 5u);
+
+    EXPECT_EQ(matching(trie, "cpu.core3.temp"), (std::vector<int>{1, 2, 3, 4}));
+    EXPECT_EQ(matching(trie, "cpu.core9.temp"), (std::vector<int>{2, 3, 4}));
+    EXPECT_EQ(matching(trie, "cpu"), (std::vector<int>{3, 4}));
+    EXPECT_EQ(matching(trie, "cpu.core3.load"), (std::vector<int>{3, 4}));
+    EXPECT_EQ(matching(trie, "mem.free"), (std::vector<int>{4, 5}));
+    EXPECT_EQ(matching(trie, "mem.free.kb"), (std::vector<int>{4}));
+}
+
+TEST(TopicTrieTest, MatchesAgreesWithTrie) {
+    const std::vector<std::string> patterns = {"a.*.c", "a.#", "*.b", "a.b.c", "#", "*"};
+    const std::vector<std::string> topics = {"a", "a.b", "a.b.c", "a.x.c", "x.b", "a.b.c.d"};
+    TopicTrie<int> trie;
+    for (int i = 0; i < static_cast<int>(patterns.size()); i++) {
+        trie.find_or_emplace(patterns[i], [i] { return i; });
+    }
+    for (const auto& t : topics) {
+        std::vector<int> expected;
+        for (int i = 0; i < static_cast<int>(patterns.size()); i++) {
+            if (TopicTrie<int>::matches(patterns[i], t)) expected.push_back(i);
+        }
+        EXPECT_EQ(matching(trie, t), expected) << t;
+    }
+}
+
+TEST(TopicTrieTest, FindAndEmplaceOnce) {
+    TopicTrie<int> trie;
+    EXPECT_EQ(trie.find("a.*"), nullptr);
+    trie.find_or_emplace("a.*", [] { return 1; });
+    trie.find_or_emplace("a.*", [] { return 2; });
+    ASSERT_NE(trie.find("a.*"), nullptr);
+    EXPECT_EQ(*trie.find("a.*"), 1);
+    EXPECT_EQ(trie.find("a"), nullptr);
+    EXPECT_EQ(trie.find("a.b"), nullptr);
+}
+
+TEST(TopicTrieTest, RejectsInnerTailWildcard) {
+    TopicTrie<int> trie;
+    EXPECT_THROW(trie.find_or_emplace("a.#.b", [] { return 1; }), std::invalid_argument);
+}
+
+TEST(TopicTrieTest, ForEachRebuildsPatterns) {
+    TopicTrie<int> trie;
+    trie.find_or_emplace("cpu.*.temp", [] { return 1; });
+    trie.find_or_emplace("cpu.#", [] { return 2; });
+    trie.find_or_emplace("mem", [] { return 3; });
+    std::vector<std::string> seen;
+    trie.for_each([&](std::string_view pattern, int&) { seen.emplace_back(pattern); });
+    std::sort(seen.begin(), seen.end());
+    EXPECT_EQ(seen, (std::vector<std::string>{"cpu.#", "cpu.*.temp", "mem"}));
+}